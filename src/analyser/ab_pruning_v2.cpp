@@ -1,114 +1,162 @@
 #include "ab_pruning_v2.h"
 
-constexpr double NEGATIVE_INFINITY = -1000000000.0;
-constexpr double POSITIVE_INFINITY =  1000000000.0;
-constexpr double MATE_MULTIPLIER   = 10000;
-constexpr int QUIESCE_DEPTH = 6;
+constexpr Score NEGATIVE_INFINITY = -SCORE_INFINITY;
+constexpr Score POSITIVE_INFINITY =  SCORE_INFINITY;
+constexpr int QUIESCE_DELTA_MARGIN = 200;
+
+// Null move pruning
+constexpr int NULL_MOVE_MIN_DEPTH = 2;
+constexpr int NULL_MOVE_REDUCTION = 2;
+constexpr int NULL_MOVE_VERIFY_PIECES = 1;
+
+// Late move reductions
+constexpr int LMR_MIN_DEPTH = 3;
+
+// Futility pruning and razoring
+constexpr int FUTILITY_MAX_DEPTH = 3;
+constexpr int RAZOR_MAX_DEPTH = 3;
+
+// Static exchange evaluation
+constexpr int SEE_PRUNE_MAX_DEPTH = 2;
+constexpr int MAX_MOVES = 256;
 
 #define max(a, b) (a > b ? a : b)
 #define min(a, b) (a < b ? a : b)
 
-int an_get_material(Chessboard& a_board) {
-	uint64_t mask = a_board.pieceMask;
-	int material = 0;
+/// Returns `true` if the move does not capture or promote a piece
+bool an_is_quiet(Chessboard& a_board, const Move a_move) {
+	int type = get_move_special(a_move) & 0b11000000;
+	return a_board.pieces[get_move_to(a_move)] == Pieces::NONE && (type == SM::NORMAL || type == SM::CASTLING);
+}
+
+/// Sort the moves so that winning captures are first and losing captures are last
+/// @return the index of the first capture that loses material
+size_t an_order_moves(Chessboard& a_board, std::vector<Move>& a_moves) {
+	size_t count = a_moves.size() < MAX_MOVES ? a_moves.size() : MAX_MOVES;
+	uint64_t keys[MAX_MOVES];
+	Move copy[MAX_MOVES];
+	size_t good = count;
+
+	for (size_t i = 0; i < count; i++) {
+		Move move = a_moves[i];
+		int score = 0x40000000;
+
+		if (!an_is_quiet(a_board, move)) {
+			int see = PieceManager::see(a_board, move);
+			score += (see >= 0) ? (0x100000 + see) : (-0x100000 + see);
 
-	if (Board::hasFlags(a_board, CastlingFlags::BLACK_CASTLE_K)) material -= 30;
-	if (Board::hasFlags(a_board, CastlingFlags::BLACK_CASTLE_Q)) material -= 30;
-	if (Board::hasFlags(a_board, CastlingFlags::WHITE_CASTLE_K)) material += 30;
-	if (Board::hasFlags(a_board, CastlingFlags::WHITE_CASTLE_Q)) material += 30;
+			if (see < 0) {
+				good--;
+			}
+		}
+
+		// Keep the generated order for moves with the same score
+		copy[i] = move;
+		keys[i] = ((uint64_t)(uint32_t)score << 32) | (uint32_t)(MAX_MOVES - i);
+	}
+
+	std::sort(keys, keys + count, std::greater<uint64_t>());
+	for (size_t i = 0; i < count; i++) {
+		a_moves[i] = copy[MAX_MOVES - (uint32_t)keys[i]];
+	}
+
+	return good;
+}
+
+template <bool White>
+int an_non_pawn_pieces(Chessboard& a_board) {
+	uint64_t mask = White ? a_board.whiteMask : a_board.blackMask;
+	int count = 0;
 
 	while (mask != 0) {
 		uint64_t pick = Utils::lowestOneBit(mask);
 		mask &= ~pick;
-		uint32_t idx = (uint32_t)Utils::numberOfTrailingZeros(pick);
-		int pic = a_board.pieces[idx];
-		int val = Serial::get_piece_value(pic);
+		int piece = a_board.pieces[Utils::numberOfTrailingZeros(pick)];
+		int pieceSq = piece * piece;
 
-		if (pic == Pieces::W_PAWN) val += (idx >> 3) * 10;
-		if (pic == Pieces::B_PAWN) val -= (8 - (idx >> 3)) * 10;
-		material += val;
+		if (pieceSq != Pieces::PAWN_SQ && pieceSq != Pieces::KING_SQ) {
+			count++;
+		}
 	}
 
-	return material;
+	return count;
 }
 
-int an_non_developing(Chessboard& a_board) {
-	int result = 0;
-	if (a_board.pieces[1] == Pieces::W_KNIGHT) result -= 10;
-	if (a_board.pieces[2] == Pieces::W_BISHOP) result -= 10;
-	if (a_board.pieces[5] == Pieces::W_BISHOP) result -= 10;
-	if (a_board.pieces[6] == Pieces::W_KNIGHT) result -= 10;
-	if (a_board.pieces[11] == Pieces::W_PAWN) result -= 11;
-	if (a_board.pieces[12] == Pieces::W_PAWN) result -= 11;
-	if (a_board.pieces[4] == Pieces::W_KING) result -= 8;
-
-	if (a_board.pieces[57] == Pieces::B_KNIGHT) result += 10;
-	if (a_board.pieces[58] == Pieces::B_BISHOP) result += 10;
-	if (a_board.pieces[61] == Pieces::B_BISHOP) result += 10;
-	if (a_board.pieces[62] == Pieces::B_KNIGHT) result += 10;
-	if (a_board.pieces[51] == Pieces::B_PAWN) result += 11;
-	if (a_board.pieces[52] == Pieces::B_PAWN) result += 11;
-	if (a_board.pieces[60] == Pieces::B_KING) result += 8;
-
-	return result * 3;
+void an_update_pv(SearchStack* stack, int ply, const Move move) {
+	SearchStack& node = stack[ply];
+	SearchStack& child = stack[ply + 1];
+
+	node.m_pv[ply] = move;
+	for (int i = ply + 1; i < child.m_pv_length; i++) {
+		node.m_pv[i] = child.m_pv[i];
+	}
+
+	node.m_pv_length = child.m_pv_length > ply + 1 ? child.m_pv_length : ply + 1;
 }
 
-int an_un_developing(Chessboard& a_board, const Move a_move) {
-	uint8_t a_move_from = get_move_from(a_move);
-	uint8_t a_move_to = get_move_to(a_move);
-	int id = a_board.pieces[a_move_from];
-	int move_to = a_move_to;
-	int result = 0;
+/// Move a move to the front of the list and keep the order of the other moves
+/// @return `false` if the move was not found
+bool an_move_to_front(std::vector<Move>& a_moves, const Move a_move, size_t& a_bad_captures) {
+	auto it = std::find(a_moves.begin(), a_moves.end(), a_move);
+	if (it == a_moves.end()) {
+		return false;
+	}
 
-	switch (id) {
-		case Pieces::W_KNIGHT: {
-			if (move_to == 1 || move_to == 6) result -= 10;
-			break;
-		}
-		case Pieces::B_KNIGHT: {
-			if (move_to == 57 || move_to == 62) result += 10;
-			break;
-		}
-		case Pieces::W_BISHOP: {
-			if (move_to == 2 || move_to == 5) result -= 10;
-			break;
-		}
-		case Pieces::B_BISHOP: {
-			if (move_to == 58 || move_to == 61) result += 10;
-			break;
-		}
-		case Pieces::W_QUEEN: result -= 5; break;
-		case Pieces::B_QUEEN: result += 5; break;
-		case Pieces::W_KING: result -= 15; break;
-		case Pieces::B_KING: result += 15; break;
+	if ((size_t)(it - a_moves.begin()) >= a_bad_captures) {
+		a_bad_captures++;
 	}
 
-	return result * 3;
+	std::rotate(a_moves.begin(), it, it + 1);
+	return true;
 }
 
-double an_get_advanced_material(Chessboard& board, const Move lastMove) {
-	double material = an_get_material(board);
-	material += an_un_developing(board, lastMove);
-	material += an_non_developing(board);
-	return material;
-}
+/// Returns the material a capture or promotion gains
+int an_capture_gain(Chessboard& a_board, const Move a_move) {
+	int type = get_move_special(a_move) & 0b11000000;
+	int gain = Serial::get_piece_value(a_board.pieces[get_move_to(a_move)]);
+	gain = gain < 0 ? -gain : gain;
+
+	if (type == SM::EN_PASSANT) {
+		gain = Serial::get_piece_value(Pieces::W_PAWN);
+	} else if (type == SM::PROMOTION) {
+		gain += Serial::get_piece_value((get_move_special(a_move) & 0b111000) >> 3) - Serial::get_piece_value(Pieces::W_PAWN);
+	}
 
-void an_update_moves(const Move move, BranchResult& result, BranchResult& branch) {
-	result.m_num_moves = branch.m_num_moves + 1;
-	result.m_moves[0] = move;
-	memcpy(result.m_moves + 1, branch.m_moves, sizeof(Move) * branch.m_num_moves);
+	return gain;
 }
 
 template<bool White>
-double an_quiesce(Chessboard& a_parent, const Move lastMove, int depth, double alpha, double beta) {
-	double evaluation = an_get_advanced_material(a_parent, lastMove);
-	if (depth == 0) {
-		return evaluation;
+Score an_quiesce(TranspositionTable& a_table, Evaluator& a_evaluator, SearchStats& a_stats, Chessboard& a_parent, const Move lastMove, int ply, Score alpha, Score beta) {
+	a_stats.m_qnodes++;
+	a_stats.m_seldepth = ply > a_stats.m_seldepth ? ply : a_stats.m_seldepth;
+
+	Score alpha_orig = alpha;
+	Score beta_orig = beta;
+	Move tt_move = 0;
+
+	a_stats.m_tt_probes++;
+	TTEntry* entry = a_table.probe(a_parent.hash);
+	if (entry != nullptr) {
+		a_stats.m_tt_hits++;
+		Score tt_value = TranspositionTable::value(entry, ply);
+		if (entry->flag == TT_EXACT
+			|| (entry->flag == TT_LOWER && tt_value >= beta)
+			|| (entry->flag == TT_UPPER && tt_value <= alpha)) {
+			a_stats.m_tt_cutoffs++;
+			return tt_value;
+		}
+
+		tt_move = entry->move;
 	}
-	
+
+	// The moves of all pieces are shared by the evaluation and the move generator
+	AttackInfo attacks;
+
+	// Stand pat. The side to move is never forced to capture
+	Score evaluation = a_evaluator.evaluate(a_parent, lastMove, attacks, alpha, beta);
 	if constexpr (White) {
 		if (evaluation >= beta) {
-			return beta;
+			return evaluation;
 		}
 		
 		if (evaluation > alpha) {
@@ -116,7 +164,7 @@ double an_quiesce(Chessboard& a_parent, const Move lastMove, int depth, double a
 		}
 	} else {
 		if (evaluation <= alpha) {
-			return alpha;
+			return evaluation;
 		}
 		
 		if (evaluation < beta) {
@@ -127,111 +175,325 @@ double an_quiesce(Chessboard& a_parent, const Move lastMove, int depth, double a
 	Chessboard board = a_parent;
 	std::vector<Move> moves;// = Generator::generate_valid_quiesce_moves(board);
 	moves.reserve(96);
-	Generator::_Generate_valid_quiesce_moves<White>(moves, board);
 
-	double value = evaluation;
+	// A lazy exit or a cached evaluation leaves the attacks empty, the captures are generated on their own then
+	Generator::_Generate_valid_quiesce_moves<White>(moves, board, attacks.m_valid ? &attacks : nullptr);
+
+	// Captures that lose material are not searched
+	size_t good_captures = an_order_moves(board, moves);
+	moves.resize(good_captures);
+	if (tt_move != 0) {
+		an_move_to_front(moves, tt_move, good_captures);
+	}
+
+	Score value = evaluation;
+	Move best_move = 0;
 	for (Move move : moves) {
+		// Castling is generated with the captures but does not resolve anything
+		if (an_is_quiet(a_parent, move)) {
+			continue;
+		}
+
+		// Delta pruning. Skip captures that cannot bring the score back into the window
+		int gain = an_capture_gain(a_parent, move) + QUIESCE_DELTA_MARGIN;
+		if (White ? (evaluation + gain <= alpha) : (evaluation - gain >= beta)) {
+			continue;
+		}
+
 		if (!Generator::playMove(board, move)) {
 			// This should never happen
 			continue;
 		}
 
-		double score = an_quiesce<!White>(board, move, depth - 1, alpha, beta);
+		Score score = an_quiesce<!White>(a_table, a_evaluator, a_stats, board, move, ply + 1, alpha, beta);
+		board = a_parent;
+
 		if constexpr (White) {
-			if (score >= beta) {
-				return beta;
-			}
-			
-			if (score > alpha) {
-				alpha = score;
+			if (score > value) {
 				value = score;
+				best_move = move;
 			}
-		} else {
-			if (score <= alpha) {
-				return alpha;
+
+			if (value >= beta) {
+				break;
 			}
-			
-			if (score < beta) {
-				beta = score;
+
+			alpha = alpha > value ? alpha : value;
+		} else {
+			if (score < value) {
 				value = score;
+				best_move = move;
 			}
+
+			if (value <= alpha) {
+				break;
+			}
+
+			beta = beta < value ? beta : value;
 		}
-		
-		board = a_parent;
 	}
-	
+
+	uint8_t flag = (value >= beta_orig) ? TT_LOWER : ((value <= alpha_orig) ? TT_UPPER : TT_EXACT);
+	a_table.store(a_parent.hash, best_move, value, 0, ply, flag);
 	return value;
 }
 
+Score an_quiesce_position(TranspositionTable& a_table, Evaluator& a_evaluator, SearchStats& a_stats, Chessboard& a_board) {
+	return Board::isWhite(a_board)
+		? an_quiesce<WHITE>(a_table, a_evaluator, a_stats, a_board, 0, 0, NEGATIVE_INFINITY, POSITIVE_INFINITY)
+		: an_quiesce<BLACK>(a_table, a_evaluator, a_stats, a_board, 0, 0, NEGATIVE_INFINITY, POSITIVE_INFINITY);
+}
+
 bool ABPruningV2::should_stop() {
-	if (!m_stop && m_max_time != 0) {
-		using namespace std::chrono;
-		int64_t time = (int64_t)(duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count() - m_start_time);
-		// fprintf(stderr, "time=%lld max=%lld\n", time, m_max_time);
+	if (m_stop.load(std::memory_order_relaxed)) {
+		return true;
+	}
 
-		if (time > m_max_time) {
-			m_stop = true;
-			return true;
-		}
+	// The node limit is checked on every node to make the result independent of the clock
+	if (m_max_nodes != 0 && m_stats.m_nodes + m_stats.m_qnodes >= m_max_nodes) {
+		m_stop.store(true, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Reading the clock is expensive so it is only polled every few nodes
+	if (--m_check_nodes > 0 || m_max_time == 0) {
+		return false;
 	}
 
-	return m_stop;
+	m_check_nodes = m_check_interval;
+
+	poll_ponderhit();
+	if (m_ponder_search) {
+		return false;
+	}
+
+	using namespace std::chrono;
+	int64_t time = (int64_t)duration_cast<milliseconds>(steady_clock::now() - m_start_time).count();
+	if (time > m_max_time) {
+		m_stop.store(true, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+
+void ABPruningV2::poll_ponderhit() {
+	if (m_ponder_search && !m_pondering.load(std::memory_order_relaxed)) {
+		// Our own clock starts running when the opponent plays the expected move
+		m_ponder_search = false;
+		m_start_time = std::chrono::steady_clock::now();
+	}
 }
 
 uint64_t an_total_nodes;
 uint64_t an_nodes;
 
 template <bool White>
-BranchResult ABPruningV2::analyse_branches(Chessboard& a_parent, const Move lastMove, int depth, double alpha, double beta) {
+Score ABPruningV2::analyse_branches(Chessboard& a_parent, const Move lastMove, int depth, int ply, Score alpha, Score beta, bool can_null) {
 	an_total_nodes++;
 	an_nodes++;
-	// Branch zero should always evaluate
-	if (depth == 0) {
-		return BranchResult{ an_quiesce<White>(a_parent, lastMove, QUIESCE_DEPTH, alpha, beta) };
+	m_stats.m_nodes++;
+	m_stats.m_seldepth = ply > m_stats.m_seldepth ? ply : m_stats.m_seldepth;
+	m_stack[ply].m_pv_length = ply;
+
+	// Branch zero should always evaluate. The same goes for the end of the search stack
+	if (depth <= 0 || ply >= MAX_PLY - 1) {
+		return an_quiesce<White>(m_table, m_evaluator, m_stats, a_parent, lastMove, ply, alpha, beta);
 	}
 
 	if (should_stop()) {
-		return BranchResult{};
+		return 0;
+	}
+
+	bool is_pv = beta - alpha > 1;
+	Score alpha_orig = alpha;
+	Score beta_orig = beta;
+	Move tt_move = 0;
+
+	// Positions that has already been searched deep enough does not need to be searched again
+	m_stats.m_tt_probes++;
+	TTEntry* entry = m_table.probe(a_parent.hash);
+	if (entry != nullptr) {
+		m_stats.m_tt_hits++;
+		Score tt_value = TranspositionTable::value(entry, ply);
+		if (!is_pv && !m_follow_pv && entry->depth >= depth && (entry->flag == TT_EXACT
+			|| (entry->flag == TT_LOWER && tt_value >= beta)
+			|| (entry->flag == TT_UPPER && tt_value <= alpha))) {
+			m_stats.m_tt_cutoffs++;
+			return tt_value;
+		}
+
+		tt_move = entry->move;
 	}
 	
 	// Default state of the board
 	Chessboard board = a_parent;
+
+	// Forward pruning is only done outside the principal variation and when not in check
+	bool in_check = PieceManager::_Is_king_attacked<White>(board);
+	bool can_prune = !is_pv && !in_check && !m_follow_pv && !score_is_mate(alpha) && !score_is_mate(beta);
+	// The moves of all pieces are shared by the evaluation and the move generator
+	AttackInfo attacks;
+	Score evaluation = can_prune ? m_evaluator.evaluate(board, lastMove, attacks) : 0;
+
+	// Razoring. Hopeless frontier nodes drop straight into quiescence
+	if (can_prune && depth <= RAZOR_MAX_DEPTH) {
+		Score margin = (Score)m_razor_margin->get_value() * depth;
+
+		if (White ? evaluation + margin <= alpha : evaluation - margin >= beta) {
+			Score score = an_quiesce<White>(m_table, m_evaluator, m_stats, a_parent, lastMove, ply, alpha, beta);
+
+			if (White ? score <= alpha : score >= beta) {
+				return score;
+			}
+		}
+	}
+
+	// Null move pruning. If passing the turn still fails high the position is good enough to cut
+	if (can_null && can_prune && depth >= NULL_MOVE_MIN_DEPTH) {
+		int pieces = an_non_pawn_pieces<White>(board);
+
+		if (pieces > 0 && (White ? evaluation >= beta : evaluation <= alpha)) {
+			int reduced = depth - 1 - (NULL_MOVE_REDUCTION + depth / 4);
+
+			m_stats.m_null_tries++;
+			Generator::playNullMove(board);
+			Score nullResult = White
+				? analyse_branches<!White>(board, 0, reduced, ply + 1, beta - 1, beta, false)
+				: analyse_branches<!White>(board, 0, reduced, ply + 1, alpha, alpha + 1, false);
+			board = a_parent;
+
+			if (White ? nullResult >= beta : nullResult <= alpha) {
+				// Zugzwang is common with few pieces so verify the cutoff with a normal search
+				if (pieces > NULL_MOVE_VERIFY_PIECES) {
+					m_stats.m_null_cutoffs++;
+					return White ? beta : alpha;
+				}
+
+				Score verifyResult = White
+					? analyse_branches<White>(board, lastMove, depth - 1 - NULL_MOVE_REDUCTION, ply, beta - 1, beta, false)
+					: analyse_branches<White>(board, lastMove, depth - 1 - NULL_MOVE_REDUCTION, ply, alpha, alpha + 1, false);
+
+				if (White ? verifyResult >= beta : verifyResult <= alpha) {
+					m_stats.m_null_cutoffs++;
+					return White ? beta : alpha;
+				}
+			}
+		}
+	}
+
 	//std::vector<Move> moves = Generator::generate_valid_moves(board);
 	std::vector<Move> moves;
 	moves.reserve(96);
-	Generator::_Generate_valid_moves<White>(moves, board);
-	double value;
-	
-	BranchResult result{};
+
+	// Reuse the moves when the evaluation calculated them, otherwise only the side to move is generated
+	Generator::_Generate_valid_moves<White>(moves, board, attacks.m_valid ? &attacks : nullptr);
+	size_t bad_captures = an_order_moves(board, moves);
+
+	// The best move from the table is most likely the best move again
+	if (tt_move != 0) {
+		an_move_to_front(moves, tt_move, bad_captures);
+	}
+
+	// Search the principal variation of the previous iteration first
+	if (m_follow_pv) {
+		m_follow_pv = ply < m_pv_length && an_move_to_front(moves, m_pv[ply], bad_captures);
+	}
+
+	// Futility pruning. Quiet moves cannot raise the evaluation enough to reach the window
+	Score futility_margin = (Score)m_futility_margin->get_value() * depth;
+	Score futility_value = White ? evaluation + futility_margin : evaluation - futility_margin;
+	bool futile = can_prune && depth <= FUTILITY_MAX_DEPTH && (White ? futility_value <= alpha : futility_value >= beta);
+
+	// Getting checkmated on this ply is the worst possible outcome
+	Score mated = score_mate_in(ply) * (White ? -1 : 1);
+	Score value;
+	Move best_move = 0;
 	
+	// Legal moves decide between mate and stalemate, searched moves decide the reductions
 	int countMoves = 0;
-	value = (MATE_MULTIPLIER * (depth + 1)) * (White ? -1 : 1);
-	for (Move move : moves) {
+	int searched = 0;
+	value = mated;
+	for (size_t i = 0; i < moves.size(); i++) {
+		Move move = moves[i];
 		if (!Generator::playMove(board, move)) {
 			continue;
 		}
 		
 		countMoves++;
+
+		// Captures that lose material are not worth searching close to the horizon
+		if (can_prune && depth <= SEE_PRUNE_MAX_DEPTH && countMoves > 1 && i >= bad_captures) {
+			board = a_parent;
+			continue;
+		}
+
+		if (futile && countMoves > 1 && an_is_quiet(a_parent, move) && !PieceManager::_Is_king_attacked<!White>(board)) {
+			value = White ? max(value, futility_value) : min(value, futility_value);
+			board = a_parent;
+			continue;
+		}
+
+		searched++;
 		
-		BranchResult scannedResult = analyse_branches<!White>(board, move, depth - 1, alpha, beta);
+		Score scannedResult;
+		if (countMoves == 1) {
+			scannedResult = analyse_branches<!White>(board, move, depth - 1, ply + 1, alpha, beta, true);
+		} else {
+			// Late quiet moves are unlikely to be good and are searched with a reduced depth first
+			int reduction = 0;
+			if (depth >= LMR_MIN_DEPTH && searched > m_lmr_min_moves->get_value() && !in_check
+				&& an_is_quiet(a_parent, move) && !PieceManager::_Is_king_attacked<!White>(board)) {
+				reduction = m_reductions[min(depth, LMR_TABLE_SIZE - 1)][min(searched, LMR_TABLE_SIZE - 1)] - (is_pv ? 1 : 0);
+				reduction = (reduction > depth - 2) ? (depth - 2) : reduction;
+				reduction = (reduction < 0) ? 0 : reduction;
+				m_stats.m_lmr_tries += (reduction > 0) ? 1 : 0;
+			}
+
+			// Later moves only have to prove that they are worse than the current best move
+			scannedResult = White
+				? analyse_branches<!White>(board, move, depth - 1 - reduction, ply + 1, alpha, alpha + 1, true)
+				: analyse_branches<!White>(board, move, depth - 1 - reduction, ply + 1, beta - 1, beta, true);
+
+			if (reduction > 0 && (White ? scannedResult > alpha : scannedResult < beta)) {
+				m_stats.m_lmr_researches++;
+				scannedResult = White
+					? analyse_branches<!White>(board, move, depth - 1, ply + 1, alpha, alpha + 1, true)
+					: analyse_branches<!White>(board, move, depth - 1, ply + 1, beta - 1, beta, true);
+			}
+
+			if (scannedResult > alpha && scannedResult < beta) {
+				scannedResult = analyse_branches<!White>(board, move, depth - 1, ply + 1, alpha, beta, true);
+			}
+		}
+
+		// Only the first move of a node can be part of the principal variation
+		m_follow_pv = false;
+
 		if constexpr (White) {
-			if (value < scannedResult.m_value) {
-				an_update_moves(move, result, scannedResult);
-				value = scannedResult.m_value;
+			if (value < scannedResult) {
+				an_update_pv(m_stack, ply, move);
+				best_move = move;
+				value = scannedResult;
 			}
 			
 			if (value >= beta) {
+				m_stats.m_beta_cutoffs++;
+				m_stats.m_first_move_cutoffs += (countMoves == 1) ? 1 : 0;
 				break;
 			}
 			
 			alpha = alpha > value ? alpha : value;
 		} else {
-			if (value > scannedResult.m_value) {
-				an_update_moves(move, result, scannedResult);
-				value = scannedResult.m_value;
+			if (value > scannedResult) {
+				an_update_pv(m_stack, ply, move);
+				best_move = move;
+				value = scannedResult;
 			}
 			
 			if (value <= alpha) {
+				m_stats.m_beta_cutoffs++;
+				m_stats.m_first_move_cutoffs += (countMoves == 1) ? 1 : 0;
 				break;
 			}
 			
@@ -241,7 +503,6 @@ BranchResult ABPruningV2::analyse_branches(Chessboard& a_parent, const Move last
 		board = a_parent;
 	}
 
-	result.m_value = value;
 	board = a_parent;
 	
 	if (countMoves == 0) {
@@ -250,26 +511,32 @@ BranchResult ABPruningV2::analyse_branches(Chessboard& a_parent, const Move last
 		
 		if (PieceManager::_Is_king_attacked<White>(board)) {
 			// Checkmate
-			result.m_value = (MATE_MULTIPLIER * (depth + 1)) * (White ? -1 : 1);
+			value = mated;
 		} else {
 			// Stalemate
-			result.m_value = 0;
+			value = 0;
 		}
 	}
 
+	// Results from an interrupted search are not reliable
+	if (!m_stop.load(std::memory_order_relaxed)) {
+		uint8_t flag = (countMoves == 0) ? TT_EXACT : ((value >= beta_orig) ? TT_LOWER : ((value <= alpha_orig) ? TT_UPPER : TT_EXACT));
+		m_table.store(a_parent.hash, best_move, value, depth, ply, flag);
+	}
+
 	board = a_parent;
-	return result;
+	return value;
 }
 
 void an_evaluate(Chessboard& board, Scanner& scan) {
 	bool isWhite = Board::isWhite(board);
 	if (PieceManager::isKingAttacked(board, isWhite)) {
-		double delta = isWhite ? -1 : 1;
+		Score delta = isWhite ? -1 : 1;
 		scan.base += 10 * delta;
 		
 		if (!get_move_valid(scan.best)) {
 			// Checkmate
-			scan.base = MATE_MULTIPLIER * delta;
+			scan.base = score_mate_in(0) * delta;
 		}
 	} else {
 		if (!get_move_valid(scan.best)) {
@@ -285,18 +552,128 @@ void an_evaluate(Chessboard& board, Scanner& scan) {
 	}
 }
 
+void ABPruningV2::order_root_moves(Chessboard& a_parent) {
+	if (m_root_moves.empty()) {
+		const std::vector<Move>& searchmoves = m_analysis.m_limits.m_searchmoves;
+
+		Chessboard board = a_parent;
+		std::vector<Move> moves = Generator::generate_valid_moves(a_parent);
+		for (Move move : moves) {
+			// Only search the moves requested with 'go searchmoves'
+			if (!searchmoves.empty() && std::find(searchmoves.begin(), searchmoves.end(), move) == searchmoves.end()) {
+				continue;
+			}
+
+			if (!Generator::playMove(board, move)) {
+				continue;
+			}
+
+			m_root_moves.push_back({ move, 0, 0 });
+			board = a_parent;
+		}
+
+		return;
+	}
+
+	// Order the moves by the result of the previous iteration. The principal variation
+	// always goes first and ties are broken by the amount of nodes the move needed
+	bool is_parent_white = Board::isWhite(a_parent);
+	Move pv_move = m_pv_length > 0 ? m_pv[0] : 0;
+	std::stable_sort(m_root_moves.begin(), m_root_moves.end(), [is_parent_white, pv_move](const RootMove& a, const RootMove& b) {
+		if (a.m_move == pv_move || b.m_move == pv_move) {
+			return a.m_move == pv_move && b.m_move != pv_move;
+		}
+
+		if (a.m_value != b.m_value) {
+			return is_parent_white ? (a.m_value > b.m_value) : (a.m_value < b.m_value);
+		}
+
+		return a.m_nodes > b.m_nodes;
+	});
+}
+
+std::string an_score_string(Score score, int mul) {
+	std::stringstream stream;
+	if (score_is_mate(score)) {
+		// Positive values means that we are checkmating the opponent
+		int plies = SCORE_MATE - (score < 0 ? -score : score);
+		stream << "mate " << (mul * score > 0 ? 1 : -1) * ((plies + 1) / 2);
+	} else {
+		stream << "cp " << mul * score;
+	}
+
+	return stream.str();
+}
+
+void ABPruningV2::print_lines(bool white, int depth, int64_t millis) {
+	// The lines are ordered by their value, the best move of the iteration always comes first
+	std::vector<RootMove*> lines;
+	for (RootMove& root_move : m_root_moves) {
+		if (root_move.m_move == m_pv[0]) {
+			lines.insert(lines.begin(), &root_move);
+		} else {
+			lines.push_back(&root_move);
+		}
+	}
+
+	std::stable_sort(lines.begin() + 1, lines.end(), [white](RootMove* a, RootMove* b) {
+		return white ? (a->m_value > b->m_value) : (a->m_value < b->m_value);
+	});
+
+	size_t count = (size_t)m_multi_pv->get_value();
+	count = count < lines.size() ? count : lines.size();
+
+	// Nodes and time are reported for the whole search, the same nodes 'go nodes' is limited by
+	uint64_t nodes = m_stats.m_nodes + m_stats.m_qnodes;
+
+	int mul = white ? 1 : -1;
+	for (size_t k = 0; k < count; k++) {
+		RootMove* line = lines[k];
+		Move* pv = (k == 0) ? m_pv : line->m_pv;
+		int pv_length = (k == 0) ? m_pv_length : line->m_pv_length;
+
+		std::stringstream pv_stream;
+		for (int j = 0; j < pv_length; j++) {
+			pv_stream << (j > 0 ? " " : "") << Serial::get_move_string(pv[j]);
+		}
+
+		printf("info depth %d seldepth %d multipv %d time %lld nodes %lld nps %lld score %s pv %s\n",
+			depth,
+			m_stats.m_seldepth,
+			(int)(k + 1),
+			millis,
+			nodes,
+			(nodes * 1000ull) / (millis + 1),
+			an_score_string(line->m_value, mul).c_str(),
+			pv_stream.str().c_str()
+		);
+	}
+
+	fflush(stdout);
+}
+
 Scanner ABPruningV2::analyse_branch_moves(Chessboard& a_parent, int depth) {
 	bool is_parent_white = Board::isWhite(a_parent);
 
 	Scanner scan { };
 	scan.bestMaterial = is_parent_white ? NEGATIVE_INFINITY : POSITIVE_INFINITY;
-	scan.base = an_get_material(a_parent);
+	AttackInfo attacks;
+	scan.base = m_evaluator.evaluate(a_parent, 0, attacks);
 	//scan.best.valid = false;
 	scan.best = 0;
+
+	order_root_moves(a_parent);
+	m_stack[0].m_pv_length = 0;
+
+	// Values of the best lines found so far ordered from best to worst. Moves only
+	// have to be searched exactly when they can beat the worst of the MultiPV lines
+	size_t multi_pv = (size_t)m_multi_pv->get_value();
+	std::vector<Score> lines;
+	lines.reserve(m_root_moves.size());
 	
 	Chessboard board = a_parent;
-	std::vector<Move> moves = Generator::generate_valid_moves(a_parent);
-	for (Move move : moves) {
+	for (RootMove& root_move : m_root_moves) {
+		Move move = root_move.m_move;
 		if (!Generator::playMove(board, move)) {
 			continue;
 		}
@@ -305,48 +682,82 @@ Scanner ABPruningV2::analyse_branch_moves(Chessboard& a_parent, int depth) {
 		if (!get_move_valid(scan.best)) {
 			//scan.best.valid = true;
 			scan.best = move;
-			scan.m_branch_result.m_num_moves = 0;
+			m_stack[0].m_pv[0] = move;
+			m_stack[0].m_pv_length = 1;
 		}
 
+		// Moves that cannot beat the current lines are searched with a narrower window
+		bool is_first = lines.size() < multi_pv;
+		Score bound = is_first ? (is_parent_white ? NEGATIVE_INFINITY : POSITIVE_INFINITY) : lines[multi_pv - 1];
+		Score alpha = is_parent_white ? bound : NEGATIVE_INFINITY;
+		Score beta = is_parent_white ? POSITIVE_INFINITY : bound;
+
 		using namespace std::chrono;
-		auto start = high_resolution_clock::now();
+		auto start = steady_clock::now();
 		an_nodes = 0;
-		BranchResult branchResult = is_parent_white
-			? analyse_branches<BLACK>(board, move, depth, NEGATIVE_INFINITY, POSITIVE_INFINITY)
-			: analyse_branches<WHITE>(board, move, depth, NEGATIVE_INFINITY, POSITIVE_INFINITY);
+		m_follow_pv = m_pv_length > 0 && move == m_pv[0];
+		Score branchResult = 0;
+		if (!is_first) {
+			branchResult = is_parent_white
+				? analyse_branches<BLACK>(board, move, depth, 1, alpha, alpha + 1, true)
+				: analyse_branches<WHITE>(board, move, depth, 1, beta - 1, beta, true);
+		}
+
+		if (is_first || (branchResult > alpha && branchResult < beta)) {
+			branchResult = is_parent_white
+				? analyse_branches<BLACK>(board, move, depth, 1, alpha, beta, true)
+				: analyse_branches<WHITE>(board, move, depth, 1, alpha, beta, true);
+		}
 
-		if (m_stop && depth > 0) {
+		if (m_stop.load(std::memory_order_relaxed) && depth > 0) {
 			break;
 		}
 
-		auto finish = high_resolution_clock::now();
-		double scannedResult = branchResult.m_value;
-		
-		{
-			fprintf(stderr, "move: %s (%.2f), [", Serial::get_move_string(move).c_str(), scannedResult / 100.0);
+		auto finish = steady_clock::now();
+		Score scannedResult = branchResult;
+		root_move.m_value = scannedResult;
+		root_move.m_nodes = an_nodes;
+		root_move.m_pv[0] = move;
+		root_move.m_pv_length = 1;
 
-			for (int i = 0; i < branchResult.m_num_moves; i++) {
-				if (i > 0) {
-					fprintf(stderr, ", ");
-				}
+		if (is_first || (is_parent_white ? scannedResult > bound : scannedResult < bound)) {
+			for (int i = 1; i < m_stack[1].m_pv_length; i++) {
+				root_move.m_pv[i] = m_stack[1].m_pv[i];
+			}
+
+			root_move.m_pv_length = m_stack[1].m_pv_length > 1 ? m_stack[1].m_pv_length : 1;
 
-				fprintf(stderr, "%s", Serial::get_move_string(branchResult.m_moves[i]).c_str());
+			auto it = is_parent_white
+				? std::upper_bound(lines.begin(), lines.end(), scannedResult, std::greater<Score>())
+				: std::upper_bound(lines.begin(), lines.end(), scannedResult);
+			lines.insert(it, scannedResult);
+		}
+		
+		if (Logger::enabled(LOG_DEBUG)) {
+			std::string pv;
+			for (int i = 1; i < root_move.m_pv_length; i++) {
+				pv += (i > 1 ? ", " : "") + Serial::get_move_string(root_move.m_pv[i]);
 			}
-			auto timeTook = duration_cast<nanoseconds>(finish-start).count();
-			fprintf(stderr, "]\t %lld nodes / sec\n", (int64_t)(an_nodes / (timeTook / 1000000000.0)));
+
+			auto timeTook = duration_cast<nanoseconds>(finish - start).count();
+			Logger::write(LOG_DEBUG, "move: %s (%.2f), [%s]\t %lld nodes / sec",
+				Serial::get_move_string(move).c_str(),
+				scannedResult / 100.0,
+				pv.c_str(),
+				(int64_t)(an_nodes / (timeTook / 1000000000.0 + 1e-9)));
 		}
 
 		if (is_parent_white) {
 			if (scan.bestMaterial < scannedResult) {
 				scan.best = move;
 				scan.bestMaterial = scannedResult;
-				scan.m_branch_result = branchResult;
+				an_update_pv(m_stack, 0, move);
 			}
 		} else {
 			if (scan.bestMaterial > scannedResult) {
 				scan.best = move;
 				scan.bestMaterial = scannedResult;
-				scan.m_branch_result = branchResult;
+				an_update_pv(m_stack, 0, move);
 			}
 		}
 
@@ -357,23 +768,31 @@ Scanner ABPruningV2::analyse_branch_moves(Chessboard& a_parent, int depth) {
 	return scan;
 }
 
-
 ABPruningV2::ABPruningV2() {
 	m_options.insert(m_options.end(), {
 		new UciOption::Spin("Skill Level", 0, 20, 20),
-		new UciOption::Spin("Move Overhead", 1, 4096, 1),
+		m_move_overhead = new UciOption::Spin("Move Overhead", 1, 4096, 10),
 		new UciOption::Spin("Threads", 1, 512, 1),
-		new UciOption::Spin("Hash", 1, 4096, 256),
-		new UciOption::String("String", "Testing this tool"),
-		new UciOption::Button("btn"),
-		new UciOption::Combo("Combo", { "Alpha", "Beta", "Gamma", "Delta" }, 0),
+		m_hash = new UciOption::Spin("Hash", 1, 4096, 256),
+		m_pawn_hash = new UciOption::Spin("Pawn Hash", 1, 256, 4),
+		m_lmr_base = new UciOption::Spin("LMR Base", 0, 400, 75),
+		m_lmr_divisor = new UciOption::Spin("LMR Divisor", 50, 1000, 225),
+		m_lmr_min_moves = new UciOption::Spin("LMR Min Moves", 1, 64, 3),
+		m_futility_margin = new UciOption::Spin("Futility Margin", 0, 1000, 125),
+		m_razor_margin = new UciOption::Spin("Razor Margin", 0, 1000, 250),
+		m_lazy_margin = new UciOption::Spin("Lazy Margin", 0, 1000, 300),
+		m_time_check = new UciOption::Spin("Time Check Nodes", 1, 65536, 2048),
+		m_ponder = new UciOption::Check("Ponder", false),
+		m_multi_pv = new UciOption::Spin("MultiPV", 1, 64, 1),
+		m_log_level = new UciOption::Combo("Log Level", { "None", "Error", "Warning", "Info", "Debug" }, LOG_WARNING),
+		m_log_file = new UciOption::String("Log File", ""),
+		m_eval_file = new UciOption::String("EvalFile", ""),
+		m_eval_mode = new UciOption::Combo("Evaluation", { "Classical", "NNUE" }, EVAL_CLASSICAL),
 
 		/*
 		new UciOption::String("NalimovPath", ""),
 		new UciOption::Spin("NalimovCache", 0, 10, 10),
-		new UciOption::Check("Ponder", false),
 		new UciOption::Check("OwnBook", false),
-		new UciOption::Spin("MultiPV", 1, 1, 1),
 		new UciOption::Check("UCI_ShowCurrLine", false),
 		new UciOption::Check("UCI_ShowRefutations", false),
 		new UciOption::Check("UCI_LimitStrength", false),
@@ -382,104 +801,290 @@ ABPruningV2::ABPruningV2() {
 		new UciOption::String("UCI_Opponent", ""),
 		*/
 	});
+
+	init_reductions();
+	m_table.resize((size_t)m_hash->get_value());
+	m_evaluator.resize_pawn_table((size_t)m_pawn_hash->get_value());
+	m_evaluator.set_lazy_margin((int)m_lazy_margin->get_value());
+
+	// The worker is created once so that starting a search only has to wake it up
+	m_running = true;
+	m_thread = std::thread(&ABPruningV2::worker_loop, this);
+}
+
+ABPruningV2::~ABPruningV2() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+		m_stop = true;
+	}
+
+	m_condition.notify_all();
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
 }
 
 void ABPruningV2::on_option_change(UciOption* option) {
 	// fprintf(stderr, "into string option change: %s\n", option->get_key());
+	if (option == m_lmr_base || option == m_lmr_divisor) {
+		init_reductions();
+	}
+
+	if (option == m_hash) {
+		m_table.resize((size_t)m_hash->get_value());
+	}
+
+	if (option == m_pawn_hash) {
+		m_evaluator.resize_pawn_table((size_t)m_pawn_hash->get_value());
+	}
+
+	if (option == m_lazy_margin) {
+		m_evaluator.set_lazy_margin((int)m_lazy_margin->get_value());
+	}
+
+	if (option == m_eval_file && !m_eval_file->get_value().empty()) {
+		if (m_evaluator.load_network(m_eval_file->get_value())) {
+			LOG(LOG_INFO, "Loaded the network [%s]", m_eval_file->get_value().c_str());
+		} else {
+			LOG(LOG_ERROR, "Could not load the network [%s]", m_eval_file->get_value().c_str());
+		}
+	}
+
+	if (option == m_eval_mode) {
+		m_evaluator.set_mode((EvalMode)m_eval_mode->get_value());
+
+		if (m_eval_mode->get_value() == EVAL_NNUE && !m_evaluator.uses_network()) {
+			LOG(LOG_WARNING, "No network loaded, using the classical evaluation");
+		}
+	}
+
+	if (option == m_log_level) {
+		Logger::set_level((LogLevel)m_log_level->get_value());
+	}
+
+	if (option == m_log_file && !Logger::set_file(m_log_file->get_value())) {
+		LOG(LOG_ERROR, "Could not open the log file [%s]", m_log_file->get_value().c_str());
+	}
+}
+
+void ABPruningV2::init_reductions() {
+	// reduction = base + ln(depth) * ln(move index) / divisor, both options are scaled by 100
+	double base = m_lmr_base->get_value() / 100.0;
+	double divisor = m_lmr_divisor->get_value() / 100.0;
+
+	for (int depth = 0; depth < LMR_TABLE_SIZE; depth++) {
+		for (int index = 0; index < LMR_TABLE_SIZE; index++) {
+			if (depth == 0 || index == 0) {
+				m_reductions[depth][index] = 0;
+				continue;
+			}
+
+			m_reductions[depth][index] = (int)(base + std::log(depth) * std::log(index) / divisor);
+		}
+	}
+}
+
+void ABPruningV2::worker_loop() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		m_condition.wait(lock, [this] { return m_searching || !m_running; });
+		if (!m_running) {
+			break;
+		}
+
+		// The position is not modified while a search is running
+		lock.unlock();
+		std::string best_move = thread_loop(m_analysis);
+		lock.lock();
+
+		// The search must be finished before the GUI sees the move, it may send 'go' right away
+		m_stop = true;
+		m_searching = false;
+		m_condition.notify_all();
+
+		printf("%s\n", best_move.c_str());
+		fflush(stdout);
+	}
 }
 
-void ABPruningV2::thread_loop(ChessAnalysis* a_analysis) {
-	m_stop = false;
+std::string ABPruningV2::thread_loop(const ChessAnalysis& a_analysis) {
+	Chessboard root = a_analysis.board;
 
 	using namespace std::chrono;
 
-	auto start_time = system_clock::now();
-	m_start_time = duration_cast<milliseconds>(start_time.time_since_epoch()).count();
-	m_max_time = a_analysis->m_max_time;
-	a_analysis->bestmove = 0; // { 0, 0, 0, false };
+	auto start_time = steady_clock::now();
+	m_start_time = start_time;
+	m_time.init(a_analysis.m_limits, Board::isWhite(root), m_move_overhead->get_value());
+	m_max_time = m_time.hard_limit();
+	m_check_interval = m_time_check->get_value();
+	m_check_nodes = m_check_interval;
+	m_ponder_search = a_analysis.m_limits.m_ponder;
+	m_stats.clear();
+	m_evaluator.m_pawn_table.m_probes = 0;
+	m_evaluator.m_pawn_table.m_hits = 0;
+	m_evaluator.m_cache.m_probes = 0;
+	m_evaluator.m_cache.m_hits = 0;
+	m_evaluator.m_lazy_exits = 0;
+	m_max_nodes = a_analysis.m_limits.m_nodes;
+
+	int max_depth = MAX_PLY - 1;
+	if (a_analysis.m_limits.m_depth != 0 && a_analysis.m_limits.m_depth < (uint64_t)max_depth) {
+		max_depth = (int)a_analysis.m_limits.m_depth;
+	}
 
 	Move best_move{};
-	int64_t total_time = 0;
 
-	int mul = (Board::isWhite(a_analysis->board) ? 1 : -1);
-	for (int i = 0; i < DEPTH && !m_stop; i++) {
+	m_root_moves.clear();
+	m_pv_length = 0;
+
+	// The first iteration always runs so that there is a move to play
+	for (int i = 0; i < max_depth && (i == 0 || !m_stop); i++) {
 		an_total_nodes = 0;
-		start_time = system_clock::now();
 
-		Scanner scanner = analyse_branch_moves(a_analysis->board, i);
-		int64_t millis = duration_cast<milliseconds>(system_clock::now() - start_time).count();
+		Scanner scanner = analyse_branch_moves(root, i);
+		int64_t millis = duration_cast<milliseconds>(steady_clock::now() - start_time).count();
 		if (i == 0 || !m_stop) {
-			int score = (int)(scanner.bestMaterial);
-			int mate = (int)(score / MATE_MULTIPLIER);
+			// Keep the principal variation for the next iteration
+			memcpy(m_pv, m_stack[0].m_pv, sizeof(Move) * m_stack[0].m_pv_length);
+			m_pv_length = m_stack[0].m_pv_length;
 
-			std::stringstream pv_stream;
-			pv_stream << Serial::get_move_string(scanner.best);
-			for (int j = 0; j < scanner.m_branch_result.m_num_moves; j++) {
-				pv_stream << " " << Serial::get_move_string(scanner.m_branch_result.m_moves[j]);
-			}
+			m_stats.add_iteration(an_total_nodes);
+			print_lines(Board::isWhite(root), i + 1, millis);
 
-			std::stringstream sc_stream;
-			if (mate != 0) {
-				// odd moves we are getting mated
-				// even moves we are checkmating the opponent
-				int dir = 1 - ((scanner.m_branch_result.m_num_moves & 1) * 2);
-				sc_stream << "mate " << (dir * (((i - (mate < 0 ? -mate : mate)) / 2) + 1));
-			} else {
-				sc_stream << "cp " << mul * score;
-			}
+			// Searches where the best move keeps changing are given more time
+			m_time.update(i > 0 && scanner.best != best_move);
 
-			printf("info depth %d time %lld nodes %lld nps %lld score %s pv %s\n",
-				i + 1,
-				millis,
-				an_total_nodes,
-				(an_total_nodes * 1000ull) / (millis + 1),
-				sc_stream.str().c_str(),
-				pv_stream.str().c_str()
-			);
-			fflush(stdout);
-
-			a_analysis->bestmove = scanner.best;
 			best_move = scanner.best;
+
+			// Stop when 'go mate' found a mate that is short enough
+			Score score = scanner.bestMaterial * (Board::isWhite(root) ? 1 : -1);
+			if (a_analysis.m_limits.m_mate != 0 && score_is_mate(score) && score > 0
+				&& (uint64_t)((SCORE_MATE - score + 1) / 2) <= a_analysis.m_limits.m_mate) {
+				break;
+			}
 		}
 
-		if (total_time + millis * 4 > m_max_time)
-		{
-			// Check if we have enough time 
+		// Check if we have enough time for another iteration
+		poll_ponderhit();
+		if (!m_ponder_search && m_time.should_stop_iteration(duration_cast<milliseconds>(steady_clock::now() - m_start_time).count())) {
 			break;
 		}
+	}
 
-		total_time += millis;
+	// Pondering and infinite searches may only report their move once they are told to
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this, &a_analysis] {
+			return m_stop || !(m_pondering || a_analysis.m_limits.m_infinite);
+		});
+
+		m_stats.m_pawn_probes = m_evaluator.m_pawn_table.m_probes;
+		m_stats.m_pawn_hits = m_evaluator.m_pawn_table.m_hits;
+		m_stats.m_eval_probes = m_evaluator.m_cache.m_probes;
+		m_stats.m_eval_hits = m_evaluator.m_cache.m_hits;
+		m_stats.m_lazy_exits = m_evaluator.m_lazy_exits;
+		m_last_stats = m_stats;
 	}
 
-	// Print the best move value for the engine
-	printf("bestmove %s\n", Serial::get_move_string(best_move).c_str());
-	fflush(stdout);
-	
-	m_stop = true;
+	printf("info string stats %s\n", m_stats.to_string().c_str());
+
+	// The best move is printed by the worker once the search is marked as finished
+	std::string result = "bestmove " + Serial::get_move_string(best_move);
+	Move ponder_move = get_ponder_move(root, best_move);
+	if (get_move_valid(ponder_move)) {
+		result += " ponder " + Serial::get_move_string(ponder_move);
+	}
+
+	return result;
 }
 
 bool ABPruningV2::stop_analysis() {
-	if (m_stop) {
-		fprintf(stderr, "Thread has already been closed!\n");
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (!m_searching) {
+		LOG(LOG_WARNING, "Thread has already been closed!");
 		return false;
 	}
 
 	m_stop = true;
-	if (m_thread.joinable()) {
-		m_thread.join();
+	m_condition.notify_all();
+	m_condition.wait(lock, [this] { return !m_searching; });
+	return true;
+}
+
+std::string ABPruningV2::get_statistics() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_last_stats.to_string();
+}
+
+bool ABPruningV2::new_game() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_searching) {
+		LOG(LOG_WARNING, "Cannot start a new game while searching!");
+		return false;
+	}
+
+	m_table.clear();
+	m_evaluator.clear();
+	return true;
+}
+
+bool ABPruningV2::ponderhit() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_searching || !m_pondering) {
+			LOG(LOG_WARNING, "Thread is not pondering!");
+			return false;
+		}
+
+		m_pondering = false;
 	}
 
+	m_condition.notify_all();
 	return true;
 }
 
+Move ABPruningV2::get_ponder_move(Chessboard& a_parent, Move best_move) {
+	if (m_pv_length > 1 && m_pv[0] == best_move) {
+		return m_pv[1];
+	}
+
+	// Use the table when the principal variation is too short
+	Chessboard board = a_parent;
+	if (!get_move_valid(best_move) || !Generator::playMove(board, best_move)) {
+		return 0;
+	}
+
+	TTEntry* entry = m_table.probe(board.hash);
+	if (entry == nullptr || !get_move_valid(entry->move)) {
+		return 0;
+	}
+
+	// Make sure the move from the table is legal in this position
+	for (Move move : Generator::generate_valid_moves(board)) {
+		if (move == entry->move) {
+			Chessboard child = board;
+			return Generator::playMove(child, move) ? move : 0;
+		}
+	}
+
+	return 0;
+}
+
 bool ABPruningV2::start_analysis(ChessAnalysis& a_analysis) {
-	if (!m_stop) {
-		fprintf(stderr, "Thread has already been started!\n");
-		return false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_searching) {
+			LOG(LOG_WARNING, "Thread has already been started!");
+			return false;
+		}
+
+		m_analysis = a_analysis;
+		m_stop = false;
+		m_pondering = a_analysis.m_limits.m_ponder;
+		m_searching = true;
 	}
 
-	m_stop = false;
-	m_thread = std::thread(&ABPruningV2::thread_loop, this, &a_analysis);
-	m_thread.detach();
+	m_condition.notify_all();
 	return true;
 }
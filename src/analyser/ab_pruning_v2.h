@@ -2,55 +2,137 @@
 #define AB_PRUNING_V2_H
 
 #include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cmath>
 #include <thread>
 #include <iostream>
 #include <sstream>
 #include "chess_analyser.h"
+#include "score.h"
+#include "transposition_table.h"
+#include "evaluator.h"
+#include "time_manager.h"
+#include "search_stats.h"
 #include "../generator.h"
 #include "../chessboard.h"
 #include "../pieces.h"
 #include "../serial.h"
 #include "../piece_manager.h"
+#include "../logger.h"
 
-constexpr int DEPTH = 7;
+constexpr int LMR_TABLE_SIZE = 64;
 
-struct BranchResult {
-	double m_value;
-	int m_num_moves;
-	Move m_moves[DEPTH];
+/// Search state of a single ply. Row `ply` of the triangular PV table holds the moves [ply, m_pv_length)
+struct SearchStack {
+	Move m_pv[MAX_PLY];
+	int m_pv_length;
 };
 
 struct Scanner {
 	bool white;
 	bool draw;
-	double base;
+	Score base;
 	Move best{};
-	double bestMaterial;
-	BranchResult m_branch_result;
+	Score bestMaterial;
 };
 
+struct RootMove {
+	Move m_move;
+	Score m_value;
+	uint64_t m_nodes;
+
+	// Principal variation starting with this move, only kept for the best MultiPV lines
+	Move m_pv[MAX_PLY];
+	int m_pv_length;
+};
+
+/// Returns the quiescence search value of a board from the view of white
+Score an_quiesce_position(TranspositionTable& table, Evaluator& evaluator, SearchStats& stats, Chessboard& board);
+
 class ABPruningV2 : public ChessAnalyser {
 public:
 	ABPruningV2();
+	virtual ~ABPruningV2();
 
 	virtual bool stop_analysis();
 	virtual bool start_analysis(ChessAnalysis& analysis);
+	virtual bool ponderhit();
+	virtual std::string get_statistics();
+	virtual bool new_game();
 
 protected:
 	virtual void on_option_change(UciOption* option);
 
 private:
-	void thread_loop(ChessAnalysis* analysis);
+	void worker_loop();
+	/// Run a search and return the 'bestmove' line
+	std::string thread_loop(const ChessAnalysis& analysis);
 	bool should_stop();
+	void poll_ponderhit();
+	Move get_ponder_move(Chessboard& parent, Move best_move);
 
 	template <bool White>
-	BranchResult analyse_branches(Chessboard& parent, const Move lastMove, int depth, double alpha, double beta);
+	Score analyse_branches(Chessboard& parent, const Move lastMove, int depth, int ply, Score alpha, Score beta, bool can_null);
 	Scanner analyse_branch_moves(Chessboard& parent, int depth);
+	void order_root_moves(Chessboard& parent);
+	void print_lines(bool white, int depth, int64_t millis);
+	void init_reductions();
 
-	uint64_t m_start_time{};
-	uint32_t m_max_time{};
-};
+	std::chrono::steady_clock::time_point m_start_time{};
+	int64_t m_max_time{};
+	TimeManager m_time;
+	UciOption::Spin* m_move_overhead;
+
+	// The clock is only read once every m_check_interval nodes
+	UciOption::Spin* m_time_check;
+	int64_t m_check_interval{};
+	int64_t m_check_nodes{};
+
+	// Limit for 'go nodes', checked against the node counter of the statistics
+	uint64_t m_max_nodes{};
+
+	// Statistics of the running search and a copy of the last finished one
+	SearchStats m_stats;
+	SearchStats m_last_stats;
+
+	// Time limits are ignored until the search thread has seen the ponderhit
+	bool m_ponder_search{};
+	UciOption::Check* m_ponder;
 
-#undef DEPTH
+	// Results from the previous iteration used for move ordering
+	std::vector<RootMove> m_root_moves;
+	Move m_pv[MAX_PLY]{};
+	int m_pv_length{};
+	bool m_follow_pv{};
+
+	// Principal variation of the current iteration, one row per ply
+	SearchStack m_stack[MAX_PLY]{};
+
+	UciOption::Spin* m_multi_pv;
+	UciOption::Combo* m_log_level;
+	UciOption::String* m_log_file;
+
+	TranspositionTable m_table;
+	UciOption::Spin* m_hash;
+
+	Evaluator m_evaluator;
+	UciOption::Spin* m_pawn_hash;
+	UciOption::String* m_eval_file;
+	UciOption::Combo* m_eval_mode;
+
+	// Late move reductions indexed by [depth][move index]
+	int m_reductions[LMR_TABLE_SIZE][LMR_TABLE_SIZE]{};
+	UciOption::Spin* m_lmr_base;
+	UciOption::Spin* m_lmr_divisor;
+	UciOption::Spin* m_lmr_min_moves;
+
+	// Margins per depth used when pruning near the horizon
+	UciOption::Spin* m_futility_margin;
+	UciOption::Spin* m_razor_margin;
+
+	// Largest value the expensive evaluation terms are expected to add
+	UciOption::Spin* m_lazy_margin;
+};
 
 #endif // AB_PRUNING_V2_H
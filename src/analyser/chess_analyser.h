@@ -2,7 +2,11 @@
 #define CHESS_ANALYSER_H
 
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
+#include "time_manager.h"
 #include "../uci/uci_option.h"
 #include "../utils.h"
 
@@ -10,12 +14,13 @@ struct ChessAnalysis {
 	Chessboard board{};
 	Move bestmove{};
 	Move ponder{};
-	uint32_t m_max_time{0};
+	SearchLimits m_limits{};
 };
 
 class ChessAnalyser {
 public:
 	ChessAnalyser() = default;
+	virtual ~ChessAnalyser() = default;
 
 	/// Returns a vector of options this analyser has
 	const std::vector<UciOption*>& get_options() {
@@ -51,15 +56,31 @@ public:
 	/// Start analyse the position
 	virtual bool start_analysis(ChessAnalysis& analysis) = 0;
 
+	/// The opponent played the expected move, continue the ponder search as a normal search
+	virtual bool ponderhit() = 0;
+
+	/// Returns the statistics of the last finished search
+	virtual std::string get_statistics() = 0;
+
+	/// Forget everything learned from previous searches before a new game starts
+	virtual bool new_game() = 0;
+
 protected:
 	/// This method is called when an option changes
 	virtual void on_option_change(UciOption* option) = 0;
 
-	ChessAnalysis* m_analysis{ nullptr };
+	/// Copy of the position being searched, only written while no search is running
+	ChessAnalysis m_analysis{};
 	std::vector<UciOption*> m_options;
+
+	// The worker thread sleeps on `m_condition` until `m_searching` is set
 	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
 	bool m_running{ false };
-	bool m_stop{ true };
+	bool m_searching{ false };
+	std::atomic<bool> m_stop{ true };
+	std::atomic<bool> m_pondering{ false };
 };
 
 #endif // CHESS_ANALYSER_H
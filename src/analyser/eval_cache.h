@@ -0,0 +1,51 @@
+#ifndef EVAL_CACHE_H
+#define EVAL_CACHE_H
+
+#include <vector>
+#include <algorithm>
+#include "score.h"
+#include "../utils_type.h"
+
+/// Direct mapped cache of static evaluations keyed by the hash of the board.
+/// Every entry is a single 64 bit word holding the upper 48 bits of the hash and
+/// the 16 bit score, so an entry is always written and read as a whole and a
+/// torn entry can never pass the key check
+class EvalCache {
+public:
+	static constexpr size_t SIZE = 1 << 16;
+	static constexpr uint64_t KEY_MASK = ~0xffffull;
+
+	EvalCache() : m_entries(SIZE) {}
+
+	/// Remove all entries
+	void clear() {
+		std::fill(m_entries.begin(), m_entries.end(), 0);
+	}
+
+	/// Returns `true` and sets the value if the hash is cached
+	bool probe(uint64_t hash, Score& value) {
+		uint64_t entry = m_entries[hash & (SIZE - 1)];
+		m_probes++;
+
+		if (entry == 0 || ((entry ^ hash) & KEY_MASK) != 0) {
+			return false;
+		}
+
+		m_hits++;
+		value = (Score)(int16_t)(entry & 0xffff);
+		return true;
+	}
+
+	/// Store the static evaluation of a hash
+	void store(uint64_t hash, Score value) {
+		m_entries[hash & (SIZE - 1)] = (hash & KEY_MASK) | (uint16_t)(int16_t)value;
+	}
+
+	uint64_t m_probes{};
+	uint64_t m_hits{};
+
+private:
+	std::vector<uint64_t> m_entries;
+};
+
+#endif // EVAL_CACHE_H
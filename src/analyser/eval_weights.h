@@ -0,0 +1,67 @@
+#ifndef EVAL_WEIGHTS_H
+#define EVAL_WEIGHTS_H
+
+#include <string>
+#include <vector>
+
+/// Tunable weights of the classical evaluation. Every term has a middlegame and an endgame weight
+struct EvalWeights {
+	int castling_rights[2] = { 30, 0 };
+	int un_developing[2] = { 3, 0 };
+
+	// Mobility per safe square indexed by the untyped piece
+	int mobility[2][7] = {
+		{ 0, 0, 1, 5, 4, 2, 0 },
+		{ 0, 0, 2, 5, 4, 4, 0 },
+	};
+
+	// Weight of each attacked square next to the enemy king indexed by the untyped piece
+	int king_attack[7] = { 0, 0, 8, 4, 4, 6, 0 };
+
+	// Pawn structure
+	int doubled[2] = { -10, -20 };
+	int isolated[2] = { -10, -15 };
+	int backward[2] = { -8, -10 };
+
+	// Passed pawn bonus indexed by the rank relative to the owner
+	int passed[2][8] = {
+		{ 0, 5, 10, 15, 25, 40, 60, 0 },
+		{ 0, 10, 20, 35, 55, 80, 110, 0 },
+	};
+
+	struct Parameter {
+		std::string name;
+		int* value;
+	};
+
+	/// Returns every weight that has an effect on the evaluation
+	std::vector<Parameter> parameters() {
+		const char* phases[2] = { "mg", "eg" };
+		const char* pieces[7] = { "", "king", "queen", "bishop", "knight", "rook", "pawn" };
+		std::vector<Parameter> result;
+
+		for (int p = 0; p < 2; p++) {
+			std::string phase = phases[p];
+			result.push_back({ "castling_rights_" + phase, &castling_rights[p] });
+			result.push_back({ "doubled_" + phase, &doubled[p] });
+			result.push_back({ "isolated_" + phase, &isolated[p] });
+			result.push_back({ "backward_" + phase, &backward[p] });
+
+			for (int i = 2; i < 6; i++) {
+				result.push_back({ "mobility_" + phase + "_" + pieces[i], &mobility[p][i] });
+			}
+
+			for (int i = 1; i < 7; i++) {
+				result.push_back({ "passed_" + phase + "_" + std::to_string(i + 1), &passed[p][i] });
+			}
+		}
+
+		for (int i = 2; i < 6; i++) {
+			result.push_back({ std::string("king_attack_") + pieces[i], &king_attack[i] });
+		}
+
+		return result;
+	}
+};
+
+#endif // EVAL_WEIGHTS_H
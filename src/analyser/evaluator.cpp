@@ -0,0 +1,188 @@
+#include "evaluator.h"
+#include "../chessboard.h"
+#include "../pieces.h"
+#include "../psqt.h"
+#include "../piece_manager.h"
+
+// Percentage of the attack weight that counts by the amount of attacking pieces
+constexpr int KING_ATTACKERS_SCALE[8] = { 0, 0, 50, 75, 88, 94, 97, 99 };
+
+/// Returns the castling rights of white minus the castling rights of black
+static int ev_castling_rights(Chessboard& a_board) {
+	int rights = 0;
+
+	if (Board::hasFlags(a_board, CastlingFlags::BLACK_CASTLE_K)) rights--;
+	if (Board::hasFlags(a_board, CastlingFlags::BLACK_CASTLE_Q)) rights--;
+	if (Board::hasFlags(a_board, CastlingFlags::WHITE_CASTLE_K)) rights++;
+	if (Board::hasFlags(a_board, CastlingFlags::WHITE_CASTLE_Q)) rights++;
+
+	return rights;
+}
+
+static int ev_un_developing(Chessboard& a_board, const Move a_move) {
+	// Null moves does not develop anything
+	if (!get_move_valid(a_move)) {
+		return 0;
+	}
+
+	// Castling develops the king and the rook
+	if ((get_move_special(a_move) & 0b11000000) == SM::CASTLING) {
+		return 0;
+	}
+
+	uint8_t a_move_from = get_move_from(a_move);
+	uint8_t a_move_to = get_move_to(a_move);
+	int id = a_board.pieces[a_move_from];
+	int move_to = a_move_to;
+	int result = 0;
+
+	switch (id) {
+		case Pieces::W_KNIGHT: {
+			if (move_to == 1 || move_to == 6) result -= 10;
+			break;
+		}
+		case Pieces::B_KNIGHT: {
+			if (move_to == 57 || move_to == 62) result += 10;
+			break;
+		}
+		case Pieces::W_BISHOP: {
+			if (move_to == 2 || move_to == 5) result -= 10;
+			break;
+		}
+		case Pieces::B_BISHOP: {
+			if (move_to == 58 || move_to == 61) result += 10;
+			break;
+		}
+		case Pieces::W_QUEEN: result -= 5; break;
+		case Pieces::B_QUEEN: result += 5; break;
+		case Pieces::W_KING: result -= 15; break;
+		case Pieces::B_KING: result += 15; break;
+	}
+
+	return result;
+}
+
+/// Adds the mobility and the attacks on the enemy king of one side. Only squares
+/// not attacked by enemy pawns count towards the mobility
+template <bool White>
+static void ev_activity(Chessboard& board, const EvalWeights& weights, const AttackInfo& attacks, int& mg, int& eg) {
+	uint64_t mask = White ? board.whiteMask : board.blackMask;
+	uint64_t safe = ~attacks.m_pawn_attacks[White ? 1 : 0];
+
+	int king = PieceManager::_Get_first<White ? Pieces::B_KING : Pieces::W_KING>(board);
+	uint64_t king_zone = king == -1 ? 0 : (PieceManager::_King_move(king) | (1ull << king));
+
+	int mobility_mg = 0, mobility_eg = 0;
+	int attackers = 0, attack_weight = 0;
+
+	while (mask != 0) {
+		uint64_t pick = Utils::lowestOneBit(mask);
+		mask &= ~pick;
+		uint32_t idx = Utils::numberOfTrailingZeros(pick);
+
+		int type = board.pieces[idx];
+		type = type < 0 ? -type : type;
+		if (type == Pieces::PAWN || type == Pieces::KING) {
+			continue;
+		}
+
+		uint64_t moves = attacks.m_moves[idx];
+		int count = Utils::bitCount(moves & safe);
+		mobility_mg += count * weights.mobility[0][type];
+		mobility_eg += count * weights.mobility[1][type];
+
+		uint64_t zone = moves & king_zone;
+		if (zone != 0) {
+			attackers++;
+			attack_weight += Utils::bitCount(zone) * weights.king_attack[type];
+		}
+	}
+
+	int danger = attack_weight * KING_ATTACKERS_SCALE[attackers < 7 ? attackers : 7] / 100;
+	mg += White ? (mobility_mg + danger) : -(mobility_mg + danger);
+	eg += White ? mobility_eg : -mobility_eg;
+}
+
+/// Tapered static evaluation. The piece-square sums are kept by the board, the pawn
+/// structure is cached and the remaining terms are weighted separately for each phase.
+/// The cheap terms are evaluated first and `exact` is cleared when they are already
+/// outside the lazy window, the attacks are only calculated when they are needed
+static Score ev_evaluate_position(Chessboard& board, const EvalWeights& weights, AttackInfo& attacks, PawnTable& pawn_table, Score lazy_alpha, Score lazy_beta, bool& exact) {
+	int mg = board.psqtMg;
+	int eg = board.psqtEg;
+
+	PawnEntry* pawns = pawn_table.probe(board, weights);
+	mg += pawns->mg;
+	eg += pawns->eg;
+
+	int rights = ev_castling_rights(board);
+	mg += rights * weights.castling_rights[0];
+	eg += rights * weights.castling_rights[1];
+
+	Score lazy = PSQT::taper(board, mg, eg);
+	if (lazy <= lazy_alpha || lazy >= lazy_beta) {
+		exact = false;
+		return lazy;
+	}
+
+	if (!attacks.m_valid) {
+		PieceManager::compute_attacks(board, attacks);
+	}
+
+	ev_activity<true>(board, weights, attacks, mg, eg);
+	ev_activity<false>(board, weights, attacks, mg, eg);
+
+	return PSQT::taper(board, mg, eg);
+}
+
+Score Evaluator::evaluate(Chessboard& board, const Move lastMove, AttackInfo& attacks, Score alpha, Score beta) {
+	// Only the terms of the position are cached, the last move is not part of the hash
+	Score value;
+	if (!m_cache.probe(board.hash, value)) {
+		bool exact = true;
+		value = uses_network()
+			? m_network.evaluate(board, m_accumulator)
+			: ev_evaluate_position(board, m_weights, attacks, m_pawn_table, alpha - m_lazy_margin, beta + m_lazy_margin, exact);
+
+		// Lazy values are only bounds and are not cached
+		if (exact) {
+			m_cache.store(board.hash, value);
+		} else {
+			m_lazy_exits++;
+		}
+	}
+
+	// The network has learned its own idea of development
+	if (uses_network()) {
+		return value;
+	}
+
+	int developing = ev_un_developing(board, lastMove);
+	if (developing != 0) {
+		value += PSQT::taper(board, developing * m_weights.un_developing[0], developing * m_weights.un_developing[1]);
+	}
+
+	return value;
+}
+
+bool Evaluator::load_network(const std::string& path) {
+	if (!m_network.load(path)) {
+		return false;
+	}
+
+	m_accumulator.m_valid = false;
+	m_cache.clear();
+	return true;
+}
+
+void Evaluator::set_mode(EvalMode mode) {
+	if (m_mode != mode) {
+		m_mode = mode;
+		m_cache.clear();
+	}
+}
+
+void Evaluator::set_weights(const EvalWeights& weights) {
+	m_weights = weights;
+	clear();
+}
@@ -0,0 +1,70 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include "score.h"
+#include "pawn_table.h"
+#include "eval_cache.h"
+#include "eval_weights.h"
+#include "nnue.h"
+#include "../utils_type.h"
+#include "../piece_manager.h"
+
+enum EvalMode {
+	EVAL_CLASSICAL,
+	EVAL_NNUE,
+};
+
+/// Static evaluation of a position from the view of white
+class Evaluator {
+public:
+	Evaluator() = default;
+
+	/// Returns the tapered evaluation of the board. The last move is used to penalise undeveloping moves.
+	/// The attacks are calculated when the evaluation needs them and are shared with the move generator.
+	/// Evaluations further than the lazy margin outside the window may skip the expensive terms
+	Score evaluate(Chessboard& board, const Move lastMove, AttackInfo& attacks, Score alpha = -SCORE_INFINITY, Score beta = SCORE_INFINITY);
+
+	/// Set the largest value the expensive terms are expected to add
+	void set_lazy_margin(int margin) {
+		m_lazy_margin = margin;
+	}
+
+	/// Resize the pawn hash table to use at most `megabytes` of memory
+	void resize_pawn_table(size_t megabytes) {
+		m_pawn_table.resize(megabytes);
+	}
+
+	/// Load the network used by the NNUE evaluation
+	/// @return `false` if the file could not be loaded
+	bool load_network(const std::string& path);
+
+	/// Select the evaluation. NNUE falls back to the classical evaluation until a network is loaded
+	void set_mode(EvalMode mode);
+
+	/// Returns `true` if positions are evaluated by the network
+	bool uses_network() const {
+		return m_mode == EVAL_NNUE && m_network.loaded();
+	}
+
+	/// Replace the weights of the classical evaluation. This removes all cached entries
+	void set_weights(const EvalWeights& weights);
+
+	/// Remove all cached entries
+	void clear() {
+		m_pawn_table.clear();
+		m_cache.clear();
+	}
+
+	PawnTable m_pawn_table;
+	EvalCache m_cache;
+	uint64_t m_lazy_exits{};
+
+private:
+	EvalWeights m_weights;
+	int m_lazy_margin{};
+	EvalMode m_mode{ EVAL_CLASSICAL };
+	NNUE::Network m_network;
+	NNUE::Accumulator m_accumulator{};
+};
+
+#endif // EVALUATOR_H
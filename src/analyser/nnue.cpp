@@ -0,0 +1,302 @@
+#include <cstdio>
+#include <cstring>
+#include "nnue.h"
+#include "../chessboard.h"
+#include "../pieces.h"
+#include "../utils.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_USE_AVX2
+#define NNUE_TARGET_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define NNUE_USE_SSE2
+// Builds without AVX2 still contain the AVX2 kernels and select them when the cpu supports them
+#define NNUE_DETECT_AVX2
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NNUE_TARGET_AVX2
+#else
+#define NNUE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Boards where more squares changed since the last evaluation are calculated from scratch
+constexpr int NNUE_MAX_CHANGES = 16;
+
+/// Returns the feature of a piece seen from one side or `-1` for empty squares and kings
+static int nn_feature(int side, int king, int piece, int idx) {
+	int type = piece < 0 ? -piece : piece;
+	if (type == Pieces::NONE || type == Pieces::KING) {
+		return -1;
+	}
+
+	// Both perspectives see the board from their own side
+	int orient = side == 0 ? 0 : 56;
+	int index = (type - Pieces::QUEEN) * 2 + ((piece > 0) == (side == 0) ? 0 : 1);
+	return (king ^ orient) * NNUE::PIECE_FEATURES + index * 64 + (idx ^ orient);
+}
+
+#if defined(NNUE_DETECT_AVX2)
+/// Returns `true` if the cpu and the operating system support AVX2
+static bool nn_detect_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+
+	// The operating system must save the upper halves of the registers
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+	if (!osxsave || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static const bool nn_has_avx2 = nn_detect_avx2();
+#endif
+
+#if defined(NNUE_USE_AVX2) || defined(NNUE_DETECT_AVX2)
+NNUE_TARGET_AVX2 static void nn_add_avx2(int16_t* values, const int16_t* weights) {
+	for (int i = 0; i < NNUE::HIDDEN; i += 16) {
+		__m256i v = _mm256_load_si256((const __m256i*)(values + i));
+		__m256i w = _mm256_loadu_si256((const __m256i*)(weights + i));
+		_mm256_store_si256((__m256i*)(values + i), _mm256_add_epi16(v, w));
+	}
+}
+
+NNUE_TARGET_AVX2 static void nn_sub_avx2(int16_t* values, const int16_t* weights) {
+	for (int i = 0; i < NNUE::HIDDEN; i += 16) {
+		__m256i v = _mm256_load_si256((const __m256i*)(values + i));
+		__m256i w = _mm256_loadu_si256((const __m256i*)(weights + i));
+		_mm256_store_si256((__m256i*)(values + i), _mm256_sub_epi16(v, w));
+	}
+}
+
+NNUE_TARGET_AVX2 static int32_t nn_dot_avx2(const int16_t* values, const int16_t* weights) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i clip = _mm256_set1_epi16(NNUE::CLIP);
+	__m256i sum = _mm256_setzero_si256();
+
+	for (int i = 0; i < NNUE::HIDDEN; i += 16) {
+		__m256i v = _mm256_load_si256((const __m256i*)(values + i));
+		__m256i w = _mm256_loadu_si256((const __m256i*)(weights + i));
+		v = _mm256_min_epi16(_mm256_max_epi16(v, zero), clip);
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, w));
+	}
+
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+	return _mm_cvtsi128_si32(half);
+}
+#endif
+
+static void nn_add(int16_t* values, const int16_t* weights) {
+#if defined(NNUE_USE_AVX2)
+	nn_add_avx2(values, weights);
+#elif defined(NNUE_USE_SSE2)
+	if (nn_has_avx2) {
+		nn_add_avx2(values, weights);
+		return;
+	}
+
+	for (int i = 0; i < NNUE::HIDDEN; i += 8) {
+		__m128i v = _mm_load_si128((const __m128i*)(values + i));
+		__m128i w = _mm_loadu_si128((const __m128i*)(weights + i));
+		_mm_store_si128((__m128i*)(values + i), _mm_add_epi16(v, w));
+	}
+#else
+	for (int i = 0; i < NNUE::HIDDEN; i++) {
+		values[i] += weights[i];
+	}
+#endif
+}
+
+static void nn_sub(int16_t* values, const int16_t* weights) {
+#if defined(NNUE_USE_AVX2)
+	nn_sub_avx2(values, weights);
+#elif defined(NNUE_USE_SSE2)
+	if (nn_has_avx2) {
+		nn_sub_avx2(values, weights);
+		return;
+	}
+
+	for (int i = 0; i < NNUE::HIDDEN; i += 8) {
+		__m128i v = _mm_load_si128((const __m128i*)(values + i));
+		__m128i w = _mm_loadu_si128((const __m128i*)(weights + i));
+		_mm_store_si128((__m128i*)(values + i), _mm_sub_epi16(v, w));
+	}
+#else
+	for (int i = 0; i < NNUE::HIDDEN; i++) {
+		values[i] -= weights[i];
+	}
+#endif
+}
+
+/// Returns the dot product of the clipped accumulator and the output weights
+static int32_t nn_dot(const int16_t* values, const int16_t* weights) {
+#if defined(NNUE_USE_AVX2)
+	return nn_dot_avx2(values, weights);
+#elif defined(NNUE_USE_SSE2)
+	if (nn_has_avx2) {
+		return nn_dot_avx2(values, weights);
+	}
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i clip = _mm_set1_epi16(NNUE::CLIP);
+	__m128i sum = _mm_setzero_si128();
+
+	for (int i = 0; i < NNUE::HIDDEN; i += 8) {
+		__m128i v = _mm_load_si128((const __m128i*)(values + i));
+		__m128i w = _mm_loadu_si128((const __m128i*)(weights + i));
+		v = _mm_min_epi16(_mm_max_epi16(v, zero), clip);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(v, w));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+	return _mm_cvtsi128_si32(sum);
+#else
+	int32_t sum = 0;
+	for (int i = 0; i < NNUE::HIDDEN; i++) {
+		int16_t v = values[i] < 0 ? 0 : (values[i] > NNUE::CLIP ? NNUE::CLIP : values[i]);
+		sum += v * weights[i];
+	}
+
+	return sum;
+#endif
+}
+
+/// Read `count` little endian values from the file
+template <typename T>
+static bool nn_read(FILE* file, T* data, size_t count) {
+	return fread(data, sizeof(T), count, file) == count;
+}
+
+bool NNUE::Network::load(const std::string& path) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr) {
+		return false;
+	}
+
+	uint32_t header[3];
+	std::vector<int16_t> feature_weights((size_t)INPUTS * HIDDEN);
+	std::vector<int16_t> feature_bias(HIDDEN);
+	std::vector<int8_t> output_weights(2 * HIDDEN);
+	int32_t output_bias;
+
+	bool valid = nn_read(file, header, 3)
+		&& header[0] == FILE_MAGIC
+		&& header[1] == (uint32_t)INPUTS
+		&& header[2] == (uint32_t)HIDDEN
+		&& nn_read(file, feature_bias.data(), feature_bias.size())
+		&& nn_read(file, feature_weights.data(), feature_weights.size())
+		&& nn_read(file, output_weights.data(), output_weights.size())
+		&& nn_read(file, &output_bias, 1);
+	fclose(file);
+
+	if (!valid) {
+		return false;
+	}
+
+	// The output weights are widened so the dot product can multiply 16 bit pairs
+	m_feature_weights = std::move(feature_weights);
+	m_feature_bias = std::move(feature_bias);
+	m_output_weights.assign(output_weights.begin(), output_weights.end());
+	m_output_bias = output_bias;
+	m_loaded = true;
+	return true;
+}
+
+void NNUE::Network::refresh(Chessboard& board, Accumulator& accumulator, int side) const {
+	int16_t* values = accumulator.m_values[side];
+	memcpy(values, m_feature_bias.data(), sizeof(int16_t) * HIDDEN);
+
+	int king = accumulator.m_king[side];
+	uint64_t mask = board.pieceMask;
+	while (mask != 0) {
+		uint64_t pick = Utils::lowestOneBit(mask);
+		mask &= ~pick;
+
+		uint32_t idx = Utils::numberOfTrailingZeros(pick);
+		int feature = nn_feature(side, king, board.pieces[idx], idx);
+		if (feature >= 0) {
+			nn_add(values, &m_feature_weights[(size_t)feature * HIDDEN]);
+		}
+	}
+}
+
+void NNUE::Network::update(Chessboard& board, Accumulator& accumulator) const {
+	int changed[64];
+	int count = 0;
+	int king[2] = { accumulator.m_king[0], accumulator.m_king[1] };
+
+	if (accumulator.m_valid) {
+		for (int idx = 0; idx < 64; idx++) {
+			if (board.pieces[idx] != accumulator.m_pieces[idx]) {
+				changed[count++] = idx;
+
+				if (board.pieces[idx] == Pieces::W_KING) king[0] = idx;
+				if (board.pieces[idx] == Pieces::B_KING) king[1] = idx;
+			}
+		}
+	}
+
+	if (!accumulator.m_valid || count > NNUE_MAX_CHANGES) {
+		for (int idx = 0; idx < 64; idx++) {
+			if (board.pieces[idx] == Pieces::W_KING) king[0] = idx;
+			if (board.pieces[idx] == Pieces::B_KING) king[1] = idx;
+		}
+
+		accumulator.m_king[0] = king[0];
+		accumulator.m_king[1] = king[1];
+		refresh(board, accumulator, 0);
+		refresh(board, accumulator, 1);
+	} else {
+		for (int side = 0; side < 2; side++) {
+			// Every feature depends on the king square of the perspective
+			if (king[side] != accumulator.m_king[side]) {
+				accumulator.m_king[side] = king[side];
+				refresh(board, accumulator, side);
+				continue;
+			}
+
+			int16_t* values = accumulator.m_values[side];
+			for (int i = 0; i < count; i++) {
+				int idx = changed[i];
+				int removed = nn_feature(side, king[side], accumulator.m_pieces[idx], idx);
+				int added = nn_feature(side, king[side], board.pieces[idx], idx);
+
+				if (removed >= 0) nn_sub(values, &m_feature_weights[(size_t)removed * HIDDEN]);
+				if (added >= 0) nn_add(values, &m_feature_weights[(size_t)added * HIDDEN]);
+			}
+		}
+	}
+
+	memcpy(accumulator.m_pieces, board.pieces, sizeof(accumulator.m_pieces));
+	accumulator.m_valid = true;
+}
+
+Score NNUE::Network::evaluate(Chessboard& board, Accumulator& accumulator) const {
+	update(board, accumulator);
+
+	// The side to move is always the first half of the input of the output layer
+	int us = Board::isWhite(board) ? 0 : 1;
+	int32_t sum = m_output_bias
+		+ nn_dot(accumulator.m_values[us], &m_output_weights[0])
+		+ nn_dot(accumulator.m_values[us ^ 1], &m_output_weights[HIDDEN]);
+
+	Score value = (Score)(((int64_t)sum * OUTPUT_SCALE) / (CLIP * OUTPUT_QUANT));
+	value = value < -SCORE_MATE_BOUND + 1 ? -SCORE_MATE_BOUND + 1 : (value > SCORE_MATE_BOUND - 1 ? SCORE_MATE_BOUND - 1 : value);
+	return us == 0 ? value : -value;
+}
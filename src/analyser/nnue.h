@@ -0,0 +1,61 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <string>
+#include <vector>
+#include "score.h"
+#include "../utils_type.h"
+
+namespace NNUE {
+	// HalfKP features. Every perspective has one feature for each king square, non king piece and square
+	constexpr int HIDDEN = 256;
+	constexpr int PIECE_FEATURES = 10 * 64;
+	constexpr int INPUTS = 64 * PIECE_FEATURES;
+
+	// Quantization of the accumulator and the output weights
+	constexpr int CLIP = 127;
+	constexpr int OUTPUT_QUANT = 64;
+	constexpr int OUTPUT_SCALE = 400;
+
+	// Header of the network file, followed by the little endian weights
+	constexpr uint32_t FILE_MAGIC = 0x31554e4e;
+
+	/// Hidden layer of both perspectives and the board they were calculated for. Consecutive
+	/// evaluations are close in the search tree, so only the squares that changed are updated
+	struct Accumulator {
+		alignas(32) int16_t m_values[2][HIDDEN];
+		int8_t m_pieces[64];
+		int m_king[2];
+		bool m_valid;
+	};
+
+	class Network {
+	public:
+		Network() = default;
+
+		/// Load a network file
+		/// @return `false` if the file could not be read or has the wrong format
+		bool load(const std::string& path);
+
+		/// Returns `true` if a network has been loaded
+		bool loaded() const {
+			return m_loaded;
+		}
+
+		/// Returns the evaluation of the board from the view of white and updates the accumulator
+		Score evaluate(Chessboard& board, Accumulator& accumulator) const;
+
+	private:
+		void refresh(Chessboard& board, Accumulator& accumulator, int side) const;
+		void update(Chessboard& board, Accumulator& accumulator) const;
+
+		// Feature transformer weights are stored as [feature][HIDDEN]
+		std::vector<int16_t> m_feature_weights;
+		std::vector<int16_t> m_feature_bias;
+		std::vector<int16_t> m_output_weights;
+		int32_t m_output_bias{};
+		bool m_loaded{};
+	};
+}
+
+#endif // NNUE_H
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include "pawn_table.h"
+#include "../pieces.h"
+#include "../utils.h"
+
+constexpr uint64_t FILE_A = 0x0101010101010101ull;
+constexpr uint64_t FILE_H = FILE_A << 7;
+
+static uint64_t pt_fill_north(uint64_t b) {
+	b |= b << 8;
+	b |= b << 16;
+	b |= b << 32;
+	return b;
+}
+
+static uint64_t pt_fill_south(uint64_t b) {
+	b |= b >> 8;
+	b |= b >> 16;
+	b |= b >> 32;
+	return b;
+}
+
+static uint64_t pt_east(uint64_t b) {
+	return (b << 1) & ~FILE_A;
+}
+
+static uint64_t pt_west(uint64_t b) {
+	return (b >> 1) & ~FILE_H;
+}
+
+/// Evaluate the pawns of one side with the board flipped so that white is the side being evaluated
+static void pt_evaluate_side(const EvalWeights& weights, uint64_t own, uint64_t enemy, bool white, int& mg, int& eg) {
+	uint64_t files = pt_fill_north(own) | pt_fill_south(own);
+	uint64_t own_front = white ? pt_fill_north(own << 8) : pt_fill_south(own >> 8);
+	uint64_t enemy_front = white ? pt_fill_south(enemy >> 8) : pt_fill_north(enemy << 8);
+
+	// Pawns with a friendly pawn in front of them
+	int doubled = Utils::bitCount(own & own_front);
+
+	// Pawns without friendly pawns on the adjacent files
+	int isolated = Utils::bitCount(own & ~(pt_east(files) | pt_west(files)));
+
+	// Pawns whose stop square is attacked by an enemy pawn and can not be defended by a friendly pawn
+	uint64_t enemy_attacks = white
+		? (pt_west(enemy >> 8) | pt_east(enemy >> 8))
+		: (pt_west(enemy << 8) | pt_east(enemy << 8));
+	uint64_t support = white
+		? pt_fill_north(pt_east(own) | pt_west(own))
+		: pt_fill_south(pt_east(own) | pt_west(own));
+	uint64_t stops = white ? (own << 8) : (own >> 8);
+	uint64_t backward_stops = stops & enemy_attacks & ~support;
+	int backward = Utils::bitCount(white ? (backward_stops >> 8) : (backward_stops << 8));
+
+	mg += doubled * weights.doubled[0] + isolated * weights.isolated[0] + backward * weights.backward[0];
+	eg += doubled * weights.doubled[1] + isolated * weights.isolated[1] + backward * weights.backward[1];
+
+	// Pawns without enemy pawns in front of them on the same or adjacent files
+	uint64_t passed = own & ~(enemy_front | pt_east(enemy_front) | pt_west(enemy_front));
+	while (passed != 0) {
+		uint64_t pick = Utils::lowestOneBit(passed);
+		passed &= ~pick;
+
+		int rank = Utils::numberOfTrailingZeros(pick) >> 3;
+		rank = white ? rank : (7 - rank);
+		mg += weights.passed[0][rank];
+		eg += weights.passed[1][rank];
+	}
+}
+
+void PawnTable::resize(size_t megabytes) {
+	size_t count = (megabytes * 1024 * 1024) / sizeof(PawnEntry);
+
+	// Use a power of two to allow masking the hash
+	size_t size = 1;
+	while (size * 2 <= count) {
+		size *= 2;
+	}
+
+	m_entries.assign(size, PawnEntry{});
+	m_mask = size - 1;
+}
+
+void PawnTable::clear() {
+	std::fill(m_entries.begin(), m_entries.end(), PawnEntry{});
+}
+
+void PawnTable::evaluate(Chessboard& board, const EvalWeights& weights, PawnEntry* entry) {
+	uint64_t white = 0;
+	uint64_t black = 0;
+
+	uint64_t mask = board.pieceMask;
+	while (mask != 0) {
+		uint64_t pick = Utils::lowestOneBit(mask);
+		mask &= ~pick;
+
+		int piece = board.pieces[Utils::numberOfTrailingZeros(pick)];
+		if (piece == Pieces::W_PAWN) white |= pick;
+		if (piece == Pieces::B_PAWN) black |= pick;
+	}
+
+	int white_mg = 0, white_eg = 0;
+	int black_mg = 0, black_eg = 0;
+	pt_evaluate_side(weights, white, black, true, white_mg, white_eg);
+	pt_evaluate_side(weights, black, white, false, black_mg, black_eg);
+
+	entry->key = board.pawnHash;
+	entry->mg = (int16_t)(white_mg - black_mg);
+	entry->eg = (int16_t)(white_eg - black_eg);
+	entry->valid = true;
+}
@@ -0,0 +1,50 @@
+#ifndef PAWN_TABLE_H
+#define PAWN_TABLE_H
+
+#include <vector>
+#include "eval_weights.h"
+#include "../utils_type.h"
+
+struct PawnEntry {
+	uint64_t key;
+	int16_t mg;
+	int16_t eg;
+	bool valid;
+};
+
+/// Cache of the pawn structure evaluation keyed by the pawn hash of the board
+class PawnTable {
+public:
+	PawnTable() = default;
+
+	/// Resize the table to use at most `megabytes` of memory. This removes all entries
+	void resize(size_t megabytes);
+
+	/// Remove all entries
+	void clear();
+
+	/// Returns the pawn structure evaluation of the board, it is calculated when it is not cached
+	PawnEntry* probe(Chessboard& board, const EvalWeights& weights) {
+		PawnEntry* entry = &m_entries[board.pawnHash & m_mask];
+		m_probes++;
+
+		if (entry->valid && entry->key == board.pawnHash) {
+			m_hits++;
+			return entry;
+		}
+
+		evaluate(board, weights, entry);
+		return entry;
+	}
+
+	uint64_t m_probes{};
+	uint64_t m_hits{};
+
+private:
+	void evaluate(Chessboard& board, const EvalWeights& weights, PawnEntry* entry);
+
+	std::vector<PawnEntry> m_entries = std::vector<PawnEntry>(1);
+	uint64_t m_mask{};
+};
+
+#endif // PAWN_TABLE_H
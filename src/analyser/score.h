@@ -0,0 +1,35 @@
+#ifndef SCORE_H
+#define SCORE_H
+
+#include <cinttypes>
+
+constexpr int MAX_PLY = 128;
+
+/// Centipawn score from the perspective of white. All values fit inside 16 bits
+typedef int32_t Score;
+
+constexpr Score SCORE_INFINITY   = 32000;
+constexpr Score SCORE_MATE       = 31000;
+constexpr Score SCORE_MATE_BOUND = SCORE_MATE - MAX_PLY;
+
+/// Returns the absolute score of a checkmate `ply` half moves from the root
+constexpr Score score_mate_in(int ply) {
+	return SCORE_MATE - ply;
+}
+
+/// Returns `true` if the score is a forced checkmate
+constexpr bool score_is_mate(Score score) {
+	return score >= SCORE_MATE_BOUND || score <= -SCORE_MATE_BOUND;
+}
+
+/// Convert a mate score from distance to the root into distance to the current node
+constexpr Score score_to_node(Score score, int ply) {
+	return (score >= SCORE_MATE_BOUND) ? (score + ply) : ((score <= -SCORE_MATE_BOUND) ? (score - ply) : score);
+}
+
+/// Convert a mate score from distance to the current node into distance to the root
+constexpr Score score_from_node(Score score, int ply) {
+	return (score >= SCORE_MATE_BOUND) ? (score - ply) : ((score <= -SCORE_MATE_BOUND) ? (score + ply) : score);
+}
+
+#endif // SCORE_H
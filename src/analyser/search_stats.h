@@ -0,0 +1,78 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <cinttypes>
+#include <string>
+#include <sstream>
+#include <iomanip>
+
+/// Counters collected by a single search thread
+struct SearchStats {
+	uint64_t m_nodes{};
+	uint64_t m_qnodes{};
+	uint64_t m_tt_probes{};
+	uint64_t m_tt_hits{};
+	uint64_t m_tt_cutoffs{};
+	uint64_t m_pawn_probes{};
+	uint64_t m_pawn_hits{};
+	uint64_t m_eval_probes{};
+	uint64_t m_eval_hits{};
+	uint64_t m_lazy_exits{};
+	uint64_t m_beta_cutoffs{};
+	uint64_t m_first_move_cutoffs{};
+	uint64_t m_null_tries{};
+	uint64_t m_null_cutoffs{};
+	uint64_t m_lmr_tries{};
+	uint64_t m_lmr_researches{};
+	int m_seldepth{};
+
+	// Nodes of the last two completed iterations
+	uint64_t m_iteration_nodes[2]{};
+
+	/// Reset all counters
+	void clear() {
+		*this = SearchStats{};
+	}
+
+	/// Record the amount of nodes a completed iteration needed
+	void add_iteration(uint64_t nodes) {
+		m_iteration_nodes[0] = m_iteration_nodes[1];
+		m_iteration_nodes[1] = nodes;
+	}
+
+	/// Returns how many times more nodes the last iteration needed than the one before
+	double branching_factor() const {
+		return m_iteration_nodes[0] == 0 ? 0.0 : (double)m_iteration_nodes[1] / (double)m_iteration_nodes[0];
+	}
+
+	/// Returns the counters formatted as `key value` pairs
+	std::string to_string() const {
+		std::stringstream stream;
+		stream << std::fixed << std::setprecision(2)
+			<< "nodes " << m_nodes
+			<< " qnodes " << m_qnodes
+			<< " tt_probes " << m_tt_probes
+			<< " tt_hits " << m_tt_hits
+			<< " tt_hit_rate " << percent(m_tt_hits, m_tt_probes)
+			<< " tt_cutoffs " << m_tt_cutoffs
+			<< " pawn_hit_rate " << percent(m_pawn_hits, m_pawn_probes)
+			<< " eval_hit_rate " << percent(m_eval_hits, m_eval_probes)
+			<< " lazy_exits " << m_lazy_exits
+			<< " beta_cutoffs " << m_beta_cutoffs
+			<< " first_move_cutoff_rate " << percent(m_first_move_cutoffs, m_beta_cutoffs)
+			<< " null_tries " << m_null_tries
+			<< " null_success_rate " << percent(m_null_cutoffs, m_null_tries)
+			<< " lmr_tries " << m_lmr_tries
+			<< " lmr_success_rate " << percent(m_lmr_tries - m_lmr_researches, m_lmr_tries)
+			<< " ebf " << branching_factor()
+			<< " seldepth " << m_seldepth;
+		return stream.str();
+	}
+
+private:
+	static double percent(uint64_t count, uint64_t total) {
+		return total == 0 ? 0.0 : (100.0 * count) / total;
+	}
+};
+
+#endif // SEARCH_STATS_H
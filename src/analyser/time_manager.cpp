@@ -0,0 +1,79 @@
+#include "time_manager.h"
+
+// Games without 'movestogo' are treated as if this many moves remain
+constexpr int64_t DEFAULT_MOVES_TO_GO = 30;
+constexpr int64_t MAX_MOVES_TO_GO = 50;
+
+// The hard limit is a multiple of the soft limit but never more than a fraction of the clock
+constexpr int64_t HARD_LIMIT_FACTOR = 5;
+constexpr int64_t MAX_CLOCK_USAGE_PERCENT = 75;
+
+// A stable best move uses less than the soft limit, an unstable one up to this much more
+constexpr double STABLE_SCALE = 0.6;
+constexpr double UNSTABLE_SCALE = 0.8;
+
+void TimeManager::init(const SearchLimits& limits, bool white, int64_t move_overhead) {
+	m_instability = 0;
+	m_fixed = false;
+
+	if (limits.m_infinite) {
+		m_soft = 0;
+		m_hard = 0;
+		return;
+	}
+
+	if (limits.m_movetime != 0) {
+		int64_t movetime = (int64_t)limits.m_movetime - move_overhead;
+		m_soft = movetime > 1 ? movetime : 1;
+		m_hard = m_soft;
+		m_fixed = true;
+		return;
+	}
+
+	int64_t time = (int64_t)limits.m_time[white ? 0 : 1];
+	int64_t inc = (int64_t)limits.m_inc[white ? 0 : 1];
+	if (time == 0) {
+		// No clock was given so there is no limit
+		m_soft = 0;
+		m_hard = 0;
+		return;
+	}
+
+	int64_t movestogo = limits.m_movestogo != 0 ? (int64_t)limits.m_movestogo : DEFAULT_MOVES_TO_GO;
+	movestogo = movestogo > MAX_MOVES_TO_GO ? MAX_MOVES_TO_GO : movestogo;
+
+	int64_t usable = time - move_overhead;
+	usable = usable > 1 ? usable : 1;
+	int64_t maximum = usable * MAX_CLOCK_USAGE_PERCENT / 100;
+	maximum = maximum > 1 ? maximum : 1;
+
+	int64_t soft = usable / movestogo + inc * 3 / 4;
+	soft = soft > maximum ? maximum : soft;
+	m_soft = soft > 1 ? soft : 1;
+
+	int64_t hard = m_soft * HARD_LIMIT_FACTOR;
+	m_hard = hard > maximum ? maximum : hard;
+}
+
+void TimeManager::update(bool best_move_changed) {
+	if (m_fixed) {
+		return;
+	}
+
+	// Recent changes weigh more than older ones
+	m_instability = m_instability * 0.5 + (best_move_changed ? 1.0 : 0.0);
+}
+
+bool TimeManager::should_stop_iteration(int64_t elapsed) const {
+	if (m_soft == 0) {
+		return false;
+	}
+
+	if (m_fixed) {
+		return elapsed >= m_hard;
+	}
+
+	double scale = STABLE_SCALE + m_instability * UNSTABLE_SCALE;
+	int64_t optimum = (int64_t)(m_soft * scale);
+	return elapsed >= (optimum < m_hard ? optimum : m_hard);
+}
@@ -0,0 +1,54 @@
+#ifndef TIME_MANAGER_H
+#define TIME_MANAGER_H
+
+#include <cstdint>
+#include <vector>
+#include "../utils_type.h"
+
+/// Limits received from the `go` command. All times are in milliseconds and zero means no limit
+struct SearchLimits {
+	uint64_t m_time[2]{};
+	uint64_t m_inc[2]{};
+	uint64_t m_movestogo{};
+	uint64_t m_movetime{};
+	uint64_t m_depth{};
+	uint64_t m_nodes{};
+	uint64_t m_mate{};
+	std::vector<Move> m_searchmoves;
+	bool m_infinite{};
+	bool m_ponder{};
+};
+
+class TimeManager {
+public:
+	TimeManager() = default;
+
+	/// Compute the limits of a new search for the side to move
+	void init(const SearchLimits& limits, bool white, int64_t move_overhead);
+
+	/// Update the stability of the best move after a completed iteration
+	void update(bool best_move_changed);
+
+	/// Returns `true` if another iteration should not be started
+	bool should_stop_iteration(int64_t elapsed) const;
+
+	/// Returns the time after which the search must stop or `0` if there is no limit
+	int64_t hard_limit() const {
+		return m_hard;
+	}
+
+	/// Returns the time the search would like to use or `0` if there is no limit
+	int64_t soft_limit() const {
+		return m_soft;
+	}
+
+private:
+	int64_t m_soft{};
+	int64_t m_hard{};
+	double m_instability{};
+
+	// A fixed movetime is used in full and is not scaled by the stability of the best move
+	bool m_fixed{};
+};
+
+#endif // TIME_MANAGER_H
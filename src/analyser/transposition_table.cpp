@@ -0,0 +1,19 @@
+#include <algorithm>
+#include "transposition_table.h"
+
+void TranspositionTable::resize(size_t megabytes) {
+	size_t count = (megabytes * 1024 * 1024) / sizeof(TTEntry);
+
+	// Use a power of two to allow masking the hash
+	size_t size = 1;
+	while (size * 2 <= count) {
+		size *= 2;
+	}
+
+	m_entries.assign(size, TTEntry{});
+	m_mask = size - 1;
+}
+
+void TranspositionTable::clear() {
+	std::fill(m_entries.begin(), m_entries.end(), TTEntry{});
+}
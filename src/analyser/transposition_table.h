@@ -0,0 +1,65 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <vector>
+#include "score.h"
+#include "../utils_type.h"
+
+enum TTFlag : uint8_t {
+	TT_NONE,
+	TT_EXACT,
+	TT_LOWER,
+	TT_UPPER,
+};
+
+struct TTEntry {
+	uint64_t key;
+	Move move;
+	int16_t value;
+	int8_t depth;
+	uint8_t flag;
+};
+
+class TranspositionTable {
+public:
+	TranspositionTable() = default;
+
+	/// Resize the table to use at most `megabytes` of memory. This removes all entries
+	void resize(size_t megabytes);
+
+	/// Remove all entries
+	void clear();
+
+	/// Returns the entry of the hash or `nullptr` if it does not exist
+	TTEntry* probe(uint64_t hash) {
+		TTEntry* entry = &m_entries[hash & m_mask];
+		return (entry->flag != TT_NONE && entry->key == hash) ? entry : nullptr;
+	}
+
+	/// Store a search result. Mate scores are stored relative to the node
+	void store(uint64_t hash, Move move, Score value, int depth, int ply, uint8_t flag) {
+		TTEntry* entry = &m_entries[hash & m_mask];
+
+		// Keep deeper results of the same position
+		if (entry->key == hash && entry->flag != TT_NONE && entry->depth > depth) {
+			return;
+		}
+
+		entry->key = hash;
+		entry->move = move;
+		entry->value = (int16_t)score_to_node(value, ply);
+		entry->depth = (int8_t)depth;
+		entry->flag = flag;
+	}
+
+	/// Returns the value of an entry relative to the root
+	static Score value(TTEntry* entry, int ply) {
+		return score_from_node(entry->value, ply);
+	}
+
+private:
+	std::vector<TTEntry> m_entries = std::vector<TTEntry>(1);
+	uint64_t m_mask{};
+};
+
+#endif // TRANSPOSITION_TABLE_H
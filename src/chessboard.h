@@ -2,6 +2,8 @@
 #define CHESSBOARD_H
 
 #include "utils_type.h"
+#include "zobrist.h"
+#include "psqt.h"
 
 namespace Board {
 	_ForceInline bool isWhite(Chessboard& board) {
@@ -62,6 +64,29 @@ namespace Board {
 		board.pieceMask = board.blackMask | board.whiteMask;
 		*/
 	}
+
+	/// Set a piece and update the hash, piece-square sums and game phase of the board
+	template <int Piece>
+	_ForceInline void setPieceHashed(Chessboard& board, uint32_t idx) {
+		int old = board.pieces[idx];
+		board.hash ^= Zobrist::piece(old, idx) ^ Zobrist::piece(Piece, idx);
+		board.pawnHash ^= Zobrist::pawn(old, idx) ^ Zobrist::pawn(Piece, idx);
+		board.psqtMg += PSQT::mg(Piece, idx) - PSQT::mg(old, idx);
+		board.psqtEg += PSQT::eg(Piece, idx) - PSQT::eg(old, idx);
+		board.phase += PSQT::phase(Piece) - PSQT::phase(old);
+		setPiece<Piece>(board, idx);
+	}
+
+	/// Set a piece and update the hash, piece-square sums and game phase of the board
+	_ForceInline void setPieceHashed(Chessboard& board, uint32_t idx, int piece) {
+		int old = board.pieces[idx];
+		board.hash ^= Zobrist::piece(old, idx) ^ Zobrist::piece(piece, idx);
+		board.pawnHash ^= Zobrist::pawn(old, idx) ^ Zobrist::pawn(piece, idx);
+		board.psqtMg += PSQT::mg(piece, idx) - PSQT::mg(old, idx);
+		board.psqtEg += PSQT::eg(piece, idx) - PSQT::eg(old, idx);
+		board.phase += PSQT::phase(piece) - PSQT::phase(old);
+		setPiece(board, idx, piece);
+	}
 }
 
 #endif // CHESSBOARD_H
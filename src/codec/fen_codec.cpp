@@ -2,6 +2,8 @@
 #include "fen_codec.h"
 #include "../serial.h"
 #include "../pieces.h"
+#include "../zobrist.h"
+#include "../psqt.h"
 
 static int _Read_number(const std::string& str, int& matched) {
 	int value = std::atoi(str.c_str() + matched);
@@ -183,6 +185,9 @@ int Codec::FEN::import_fen(Chessboard& board, std::string str, int& matched) {
 	board.whiteMask = whiteMask;
 	board.blackMask = blackMask;
 	board.pieceMask = whiteMask | blackMask;
+	board.hash = Zobrist::compute_hash(board);
+	board.pawnHash = Zobrist::compute_pawn_hash(board);
+	PSQT::compute(board);
 	return FEN_CODEC_SUCCESSFUL;
 }
 
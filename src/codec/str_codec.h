@@ -1,24 +1,88 @@
 #ifndef STR_CODEC_H
 #define STR_CODEC_H
 
-#include <string>
+#include <string_view>
+#include <charconv>
 
 namespace Codec::STR {
+	/// Returns `true` if the character separates two tokens
+	constexpr bool is_space(char c) {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	/// Returns `true` if the input starts with the prefix
+	constexpr bool starts_with(std::string_view a_input, std::string_view a_prefix) {
+		return a_input.substr(0, a_prefix.size()) == a_prefix;
+	}
+
+	/// Parse an integer that spans the whole input
+	/// @return `false` if the input is not a number
 	template <typename integer_type>
-	inline std::string read_integer(std::string& a_input, integer_type& a_output) {
-		int value = std::atoi(a_input.c_str());
-		size_t len{ 0 };
-
-		int loop = value;
-		do {
-			loop /= 10;
-			len++;
-		} while (loop != 0);
-
-		a_output = (integer_type)value;
-		return a_input.substr(len);
+	inline bool read_integer(std::string_view a_input, integer_type& a_output) {
+		const char* end = a_input.data() + a_input.size();
+		auto [ptr, ec] = std::from_chars(a_input.data(), end, a_output);
+		return ec == std::errc() && ptr == end && !a_input.empty();
 	}
 
+	/// Splits a command into whitespace separated tokens without copying it.
+	/// The tokens point into the command and are only valid as long as the command is
+	class Tokenizer {
+	public:
+		Tokenizer(std::string_view a_input) : m_input(a_input) {}
+
+		/// Returns the next token or an empty view if there are no more tokens
+		std::string_view next() {
+			std::string_view token = peek();
+			m_input.remove_prefix((size_t)(token.data() - m_input.data()) + token.size());
+			return token;
+		}
+
+		/// Returns the next token without consuming it
+		std::string_view peek() const {
+			size_t begin = 0;
+			while (begin < m_input.size() && is_space(m_input[begin])) {
+				begin++;
+			}
+
+			size_t end = begin;
+			while (end < m_input.size() && !is_space(m_input[end])) {
+				end++;
+			}
+
+			return m_input.substr(begin, end - begin);
+		}
+
+		/// Read the next token as an integer
+		/// @return `false` if the token is not a number
+		template <typename integer_type>
+		bool next_integer(integer_type& a_output) {
+			return read_integer(next(), a_output);
+		}
+
+		/// Returns the remaining input without leading whitespace
+		std::string_view rest() const {
+			size_t begin = 0;
+			while (begin < m_input.size() && is_space(m_input[begin])) {
+				begin++;
+			}
+
+			return m_input.substr(begin);
+		}
+
+		/// Skip the first `count` characters of the remaining input
+		void skip(size_t count) {
+			std::string_view remaining = rest();
+			m_input = remaining.substr(count < remaining.size() ? count : remaining.size());
+		}
+
+		/// Returns `true` if there are no more tokens
+		bool empty() const {
+			return rest().empty();
+		}
+
+	private:
+		std::string_view m_input;
+	};
 }
 
 #endif // STR_CODEC_H
@@ -109,6 +109,7 @@ namespace Generator {
 		int nextLastCapture = board.lastCapture + 1;
 		int nextHalfMove = board.halfMove + 1;
 		int nextLastPawn = 0;
+		int oldFlags = board.flags;
 		
 		switch (special & 0b11000000) {
 			case SM::NORMAL: {
@@ -190,25 +191,25 @@ namespace Generator {
 				}
 				
 				//Board::setPiece(board, fromIdx, Pieces::NONE);
-				Board::setPiece<Pieces::NONE>(board, fromIdx);
-				Board::setPiece(board, toIdx, oldFrom);
+				Board::setPieceHashed<Pieces::NONE>(board, fromIdx);
+				Board::setPieceHashed(board, toIdx, oldFrom);
 				break;
 			}
 			
 			case SM::CASTLING: {
 				if ((special & CastlingFlags::ANY_CASTLE_K) != 0) {
-					Board::setPiece<Pieces::NONE>(board, fromIdx + 3);
-					Board::setPiece(board, fromIdx + 2, Pieces::KING * mul);
-					Board::setPiece(board, fromIdx + 1, Pieces::ROOK * mul);
-					Board::setPiece<Pieces::NONE>(board, fromIdx);
+					Board::setPieceHashed<Pieces::NONE>(board, fromIdx + 3);
+					Board::setPieceHashed(board, fromIdx + 2, Pieces::KING * mul);
+					Board::setPieceHashed(board, fromIdx + 1, Pieces::ROOK * mul);
+					Board::setPieceHashed<Pieces::NONE>(board, fromIdx);
 					board.flags &= isWhite ? ~CastlingFlags::WHITE_CASTLE_ANY : ~CastlingFlags::BLACK_CASTLE_ANY;
 				}
 				
 				if ((special & CastlingFlags::ANY_CASTLE_Q) != 0) {
-					Board::setPiece<Pieces::NONE>(board, fromIdx - 4);
-					Board::setPiece(board, fromIdx - 2, Pieces::KING * mul);
-					Board::setPiece(board, fromIdx - 1, Pieces::ROOK * mul);
-					Board::setPiece<Pieces::NONE>(board, fromIdx);
+					Board::setPieceHashed<Pieces::NONE>(board, fromIdx - 4);
+					Board::setPieceHashed(board, fromIdx - 2, Pieces::KING * mul);
+					Board::setPieceHashed(board, fromIdx - 1, Pieces::ROOK * mul);
+					Board::setPieceHashed<Pieces::NONE>(board, fromIdx);
 					board.flags &= isWhite ? ~CastlingFlags::WHITE_CASTLE_ANY : ~CastlingFlags::BLACK_CASTLE_ANY;
 				}
 
@@ -220,9 +221,9 @@ namespace Generator {
 				int remIdx = toIdx - 8 * mul; // + (isWhite ? -8 : 8);
 				
 				nextLastCapture = 0;
-				Board::setPiece<Pieces::NONE>(board, fromIdx);
-				Board::setPiece<Pieces::NONE>(board, remIdx);
-				Board::setPiece(board, toIdx, oldFrom);
+				Board::setPieceHashed<Pieces::NONE>(board, fromIdx);
+				Board::setPieceHashed<Pieces::NONE>(board, remIdx);
+				Board::setPieceHashed(board, toIdx, oldFrom);
 				break;
 			}
 			
@@ -235,8 +236,8 @@ namespace Generator {
 					case Pieces::KNIGHT:
 					case Pieces::ROOK: {
 						int oldFrom = board.pieces[fromIdx];
-						Board::setPiece<Pieces::NONE>(board, fromIdx);
-						Board::setPiece(board, toIdx, piece * mul);
+						Board::setPieceHashed<Pieces::NONE>(board, fromIdx);
+						Board::setPieceHashed(board, toIdx, piece * mul);
 						
 						if (oldFrom != 0) {
 							nextLastCapture = 0;
@@ -252,6 +253,10 @@ namespace Generator {
 			}
 		}
 		
+		board.hash ^= Zobrist::castling(oldFlags) ^ Zobrist::castling(board.flags);
+		board.hash ^= Zobrist::en_passant(board.lastPawn) ^ Zobrist::en_passant(nextLastPawn);
+		board.hash ^= Zobrist::side();
+
 		board.lastCapture = nextLastCapture;
 		board.lastPawn = nextLastPawn;
 		board.halfMove = nextHalfMove;
@@ -261,4 +266,11 @@ namespace Generator {
 	bool playMove(Chessboard& board, const Move move) {
 		return playMove(board, get_move_from(move), get_move_to(move), get_move_special(move));
 	}
+
+	void playNullMove(Chessboard& board) {
+		board.hash ^= Zobrist::en_passant(board.lastPawn) ^ Zobrist::side();
+		board.lastCapture = board.lastCapture + 1;
+		board.lastPawn = 0;
+		board.halfMove = board.halfMove + 1;
+	}
 }
@@ -109,7 +109,7 @@ namespace Generator {
 	}
 
 	template <bool White>
-	_Inline void _Generate_valid_quiesce_moves(std::vector<Move>& vector_moves, Chessboard& board) {
+	_Inline void _Generate_valid_quiesce_moves(std::vector<Move>& vector_moves, Chessboard& board, const AttackInfo* attacks = nullptr) {
 		uint64_t mask;
 		if constexpr (White) {
 			mask = board.whiteMask;
@@ -132,7 +132,7 @@ namespace Generator {
 			uint8_t idx = Utils::numberOfTrailingZeros(pick);
 
 			int piece = board.pieces[idx];
-			uint64_t moves = PieceManager::piece_move(board, piece, idx);
+			uint64_t moves = attacks != nullptr ? attacks->m_moves[idx] : PieceManager::piece_move(board, piece, idx);
 
 			while (moves != 0) {
 				uint64_t move_bit = Utils::lowestOneBit(moves);
@@ -237,7 +237,7 @@ namespace Generator {
 	}
 
 	template <bool White>
-	_Inline void _Generate_valid_moves(std::vector<Move>& vector_moves, Chessboard& board) {
+	_Inline void _Generate_valid_moves(std::vector<Move>& vector_moves, Chessboard& board, const AttackInfo* attacks = nullptr) {
 		uint64_t mask;
 		if constexpr (White) {
 			mask = board.whiteMask;
@@ -260,7 +260,7 @@ namespace Generator {
 			uint8_t idx = Utils::numberOfTrailingZeros(pick);
 
 			int piece = board.pieces[idx];
-			uint64_t moves = PieceManager::piece_move(board, piece, idx);
+			uint64_t moves = attacks != nullptr ? attacks->m_moves[idx] : PieceManager::piece_move(board, piece, idx);
 
 			while (moves != 0) {
 				uint64_t move_bit = Utils::lowestOneBit(moves);
@@ -386,6 +386,9 @@ namespace Generator {
 
 	// bool playMove(Chessboard& board, uint8_t fromIdx, uint8_t toIdx, uint8_t special);
 	bool playMove(Chessboard& board, const Move move);
+
+	/// Pass the turn to the opponent without moving a piece
+	void playNullMove(Chessboard& board);
 }
 
 #endif // GENERATOR_H
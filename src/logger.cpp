@@ -0,0 +1,149 @@
+#include <cstdio>
+#include <cstdarg>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include "logger.h"
+
+// Must be a power of two
+constexpr size_t LOG_CAPACITY = 1024;
+constexpr size_t LOG_MESSAGE_SIZE = 256;
+
+struct LogSlot {
+	std::atomic<size_t> sequence;
+	char text[LOG_MESSAGE_SIZE];
+};
+
+static const char* LOG_PREFIX[] = { "", "error: ", "warning: ", "info: ", "debug: " };
+
+// Bounded multi producer queue where each slot tells if it is ready to be written or read
+static LogSlot lg_slots[LOG_CAPACITY];
+static std::atomic<size_t> lg_head{ 0 };
+static size_t lg_tail{ 0 };
+static std::atomic<uint64_t> lg_dropped{ 0 };
+
+static std::thread lg_thread;
+static std::atomic<bool> lg_running{ false };
+
+// The output is only changed and used while holding the lock
+static std::mutex lg_output_mutex;
+static FILE* lg_output{ nullptr };
+
+std::atomic<int> Logger::g_level{ LOG_WARNING };
+
+static bool lg_pop(char* text) {
+	LogSlot& slot = lg_slots[lg_tail & (LOG_CAPACITY - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != lg_tail + 1) {
+		return false;
+	}
+
+	memcpy(text, slot.text, LOG_MESSAGE_SIZE);
+	slot.sequence.store(lg_tail + LOG_CAPACITY, std::memory_order_release);
+	lg_tail++;
+	return true;
+}
+
+static void lg_drain() {
+	char text[LOG_MESSAGE_SIZE];
+
+	std::lock_guard<std::mutex> lock(lg_output_mutex);
+	FILE* output = lg_output != nullptr ? lg_output : stderr;
+
+	uint64_t dropped = lg_dropped.exchange(0, std::memory_order_relaxed);
+	if (dropped != 0) {
+		fprintf(output, "warning: dropped %llu log messages\n", (unsigned long long)dropped);
+	}
+
+	bool written = false;
+	while (lg_pop(text)) {
+		fputs(text, output);
+		fputc('\n', output);
+		written = true;
+	}
+
+	if (written) {
+		fflush(output);
+	}
+}
+
+static void lg_thread_loop() {
+	while (lg_running.load(std::memory_order_relaxed)) {
+		lg_drain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	lg_drain();
+}
+
+void Logger::start() {
+	for (size_t i = 0; i < LOG_CAPACITY; i++) {
+		lg_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	lg_running = true;
+	lg_thread = std::thread(lg_thread_loop);
+}
+
+void Logger::stop() {
+	lg_running = false;
+	if (lg_thread.joinable()) {
+		lg_thread.join();
+	}
+
+	set_file("");
+}
+
+void Logger::set_level(LogLevel level) {
+	g_level.store(level, std::memory_order_relaxed);
+}
+
+bool Logger::set_file(const std::string& path) {
+	FILE* file = nullptr;
+	if (!path.empty()) {
+		file = fopen(path.c_str(), "a");
+		if (file == nullptr) {
+			return false;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(lg_output_mutex);
+	if (lg_output != nullptr) {
+		fclose(lg_output);
+	}
+
+	lg_output = file;
+	return true;
+}
+
+void Logger::write(LogLevel level, const char* format, ...) {
+	// Reserve a slot, the sequence of a free slot is equal to its position
+	size_t pos = lg_head.load(std::memory_order_relaxed);
+	LogSlot* slot;
+	while (true) {
+		slot = &lg_slots[pos & (LOG_CAPACITY - 1)];
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+		if (diff == 0) {
+			if (lg_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) {
+			// The buffer is full
+			lg_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		} else {
+			pos = lg_head.load(std::memory_order_relaxed);
+		}
+	}
+
+	int length = snprintf(slot->text, LOG_MESSAGE_SIZE, "%s", LOG_PREFIX[level]);
+	va_list args;
+	va_start(args, format);
+	vsnprintf(slot->text + length, LOG_MESSAGE_SIZE - length, format, args);
+	va_end(args);
+
+	slot->sequence.store(pos + 1, std::memory_order_release);
+}
@@ -0,0 +1,45 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <string>
+
+enum LogLevel : int {
+	LOG_NONE,
+	LOG_ERROR,
+	LOG_WARNING,
+	LOG_INFO,
+	LOG_DEBUG,
+};
+
+/// Messages are formatted by the calling thread into a lock-free ring buffer and
+/// written to stderr or a file by a background thread
+namespace Logger {
+	extern std::atomic<int> g_level;
+
+	/// Start the background writer
+	void start();
+
+	/// Write the remaining messages and stop the background writer
+	void stop();
+
+	/// Set the highest level that is written
+	void set_level(LogLevel level);
+
+	/// Write to the file at `path` or to stderr if the path is empty
+	/// @return `false` if the file could not be opened
+	bool set_file(const std::string& path);
+
+	/// Returns `true` if messages of this level are written
+	inline bool enabled(LogLevel level) {
+		return level <= g_level.load(std::memory_order_relaxed);
+	}
+
+	/// Format and queue a message. Messages are dropped when the buffer is full
+	void write(LogLevel level, const char* format, ...);
+}
+
+/// Arguments are not evaluated when the level is disabled
+#define LOG(level, ...) do { if (Logger::enabled(level)) { Logger::write(level, __VA_ARGS__); } } while (0)
+
+#endif // LOGGER_H
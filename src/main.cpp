@@ -6,8 +6,11 @@
 #include "generator.h"
 #include "analyser/ab_pruning_v2.h"
 #include "uci/uci_manager.h"
+#include "logger.h"
 
 int main(int argc, char** argv) {
+	Logger::start();
+
 	ChessAnalyser* analyser = new ABPruningV2();
 	UciManager manager("HardCoded", "HardCodedBot 1.0", analyser);
 
@@ -26,6 +29,8 @@ int main(int argc, char** argv) {
 
 	// This will read from cin and only exit when the 'quit' command is called
 	manager.run();
+	delete analyser;
+	Logger::stop();
 
 	/*
 	//int result = Codec::FEN::import_fen(board, "r6r/pp1k1p1p/4pq2/2ppnn2/1b3Q2/2N1P2N/PPPP1PPP/R1B1K2R w KQ - 0 12");
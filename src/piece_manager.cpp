@@ -221,6 +221,29 @@ namespace PieceManager {
 		}
 	}
 
+	void compute_attacks(Chessboard& board, AttackInfo& info) {
+		info.m_pawn_attacks[0] = 0;
+		info.m_pawn_attacks[1] = 0;
+
+		uint64_t mask = board.pieceMask;
+		while (mask != 0) {
+			uint64_t pick = Utils::lowestOneBit(mask);
+			mask &= ~pick;
+			uint32_t idx = Utils::numberOfTrailingZeros(pick);
+
+			int piece = board.pieces[idx];
+			info.m_moves[idx] = piece_move(board, piece, idx);
+
+			if (piece == Pieces::W_PAWN) {
+				info.m_pawn_attacks[0] |= _White_pawn_attack(idx);
+			} else if (piece == Pieces::B_PAWN) {
+				info.m_pawn_attacks[1] |= _Black_pawn_attack(idx);
+			}
+		}
+
+		info.m_valid = true;
+	}
+
 	uint32_t white_pawn_special_move(Chessboard& board, uint32_t idx) {
 		int ypos = idx >> 3;
 		int xpos = idx & 7;
@@ -432,6 +455,112 @@ namespace PieceManager {
 		return false;
 	}
 
+	// Piece values used by the static exchange evaluation indexed by untyped piece
+	const int SEE_VALUES[7] = { 0, 20000, 900, 300, 300, 500, 100 };
+
+	// Cheapest attackers are used first
+	const int SEE_ORDER[6] = { Pieces::PAWN, Pieces::KNIGHT, Pieces::BISHOP, Pieces::ROOK, Pieces::QUEEN, Pieces::KING };
+
+	int see(Chessboard& board, const Move move) {
+		uint8_t fromIdx = get_move_from(move);
+		uint8_t toIdx = get_move_to(move);
+		uint8_t special = get_move_special(move);
+		int type = special & 0b11000000;
+
+		if (type == SM::CASTLING) {
+			return 0;
+		}
+
+		// Split the board into masks for each untyped piece
+		uint64_t typeMask[7]{};
+		uint64_t mask = board.pieceMask;
+		while (mask != 0) {
+			uint64_t pick = Utils::lowestOneBit(mask);
+			mask &= ~pick;
+			int piece = board.pieces[Utils::numberOfTrailingZeros(pick)];
+			typeMask[piece < 0 ? -piece : piece] |= pick;
+		}
+
+		uint64_t occupied = board.pieceMask;
+		uint64_t diagonal = typeMask[Pieces::BISHOP] | typeMask[Pieces::QUEEN];
+		uint64_t straight = typeMask[Pieces::ROOK] | typeMask[Pieces::QUEEN];
+
+		int attacker = board.pieces[fromIdx];
+		bool white = attacker > 0;
+		attacker = white ? attacker : -attacker;
+
+		int gain[32];
+		int captured = board.pieces[toIdx];
+		gain[0] = SEE_VALUES[captured < 0 ? -captured : captured];
+
+		if (type == SM::EN_PASSANT) {
+			gain[0] = SEE_VALUES[Pieces::PAWN];
+			occupied &= ~(1ull << (toIdx + (white ? -8 : 8)));
+		} else if (type == SM::PROMOTION) {
+			attacker = (special & 0b111000) >> 3;
+			gain[0] += SEE_VALUES[attacker] - SEE_VALUES[Pieces::PAWN];
+		}
+
+		// All pieces that attack the target square
+		uint64_t attackers = (knight_move(toIdx) & typeMask[Pieces::KNIGHT])
+			| (king_move(toIdx) & typeMask[Pieces::KING])
+			| (black_pawn_attack(toIdx) & typeMask[Pieces::PAWN] & board.whiteMask)
+			| (white_pawn_attack(toIdx) & typeMask[Pieces::PAWN] & board.blackMask)
+			| (bishop_move(occupied, toIdx) & diagonal)
+			| (rook_move(occupied, toIdx) & straight);
+
+		uint64_t fromBit = 1ull << fromIdx;
+		int depth = 0;
+
+		for (;;) {
+			// Remove the piece that just captured and look for x-ray attackers behind it
+			occupied &= ~fromBit;
+			if (attacker == Pieces::PAWN || attacker == Pieces::BISHOP || attacker == Pieces::QUEEN) {
+				attackers |= bishop_move(occupied, toIdx) & diagonal;
+			}
+
+			if (attacker == Pieces::ROOK || attacker == Pieces::QUEEN) {
+				attackers |= rook_move(occupied, toIdx) & straight;
+			}
+
+			attackers &= occupied;
+			white = !white;
+
+			uint64_t sideAttackers = attackers & (white ? board.whiteMask : board.blackMask);
+			if (sideAttackers == 0 || depth >= 31) {
+				break;
+			}
+
+			// Find the least valuable attacker
+			int next = 0;
+			for (int piece : SEE_ORDER) {
+				uint64_t found = sideAttackers & typeMask[piece];
+				if (found != 0) {
+					fromBit = Utils::lowestOneBit(found);
+					next = piece;
+					break;
+				}
+			}
+
+			depth++;
+			gain[depth] = SEE_VALUES[attacker] - gain[depth - 1];
+			attacker = next;
+
+			// Capturing a defended piece with the king is not possible
+			if (next == Pieces::KING && (attackers & ~fromBit & (white ? board.blackMask : board.whiteMask)) != 0) {
+				depth--;
+				break;
+			}
+		}
+
+		while (depth > 0) {
+			gain[depth - 1] = -(-gain[depth - 1] > gain[depth] ? -gain[depth - 1] : gain[depth]);
+			depth--;
+		}
+
+		return gain[0];
+	}
+
 	// TODO: fixure out how to get this working
 	/*
 	template <bool WHITE>
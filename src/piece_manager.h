@@ -7,6 +7,18 @@
 #include "precomputed.h"
 #include "chessboard.h"
 
+/// Moves of every piece on a board. Calculated once per node so that the move
+/// generator and the evaluation can share them
+struct AttackInfo {
+	uint64_t m_moves[64];
+
+	// Squares attacked by the pawns of white and black
+	uint64_t m_pawn_attacks[2];
+
+	// Set once the moves have been calculated
+	bool m_valid = false;
+};
+
 namespace PieceManager {
 	extern uint64_t piece_move(Chessboard& board, int piece, uint32_t idx);
 
@@ -15,6 +27,12 @@ namespace PieceManager {
 	extern bool isAttacked(Chessboard& board, uint32_t idx);
 
 	extern bool isKingAttacked(Chessboard& board, bool isWhite);
+
+	/// Calculate the moves of every piece and the pawn attacks of both sides
+	extern void compute_attacks(Chessboard& board, AttackInfo& info);
+
+	/// Static exchange evaluation of a move in centipawns for the side that moves
+	extern int see(Chessboard& board, const Move move);
 }
 
 namespace PieceManager {
@@ -0,0 +1,105 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+#include "utils_type.h"
+#include "pieces.h"
+
+/// Piece-square tables for the middlegame and endgame. Every entry includes the material
+/// value of the piece and is stored from the perspective of white
+namespace PSQT {
+	struct Tables {
+		int16_t mg[13][64];
+		int16_t eg[13][64];
+	};
+
+	// Indexed by untyped piece
+	constexpr int MG_VALUES[7] = { 0, 0, 900, 300, 300, 500, 100 };
+	constexpr int EG_VALUES[7] = { 0, 0, 900, 300, 300, 500, 100 };
+
+	// The game phase goes from PHASE_MAX with all pieces on the board down to zero in a pawn endgame
+	constexpr int PHASE_MAX = 24;
+	constexpr int8_t PHASE_WEIGHTS[13] = { 0, 2, 1, 1, 4, 0, 0, 0, 4, 1, 1, 2, 0 };
+
+	constexpr int _Center_distance(int idx) {
+		int file = idx & 7;
+		int rank = idx >> 3;
+		return (file < 4 ? 3 - file : file - 4) + (rank < 4 ? 3 - rank : rank - 4);
+	}
+
+	/// Bonus of a white piece on a square in the middlegame
+	constexpr int _Mg_bonus(int type, int idx) {
+		int rank = idx >> 3;
+		switch (type) {
+			// Pieces on their starting squares are not developed
+			case Pieces::KNIGHT: return (idx == 1 || idx == 6) ? -30 : 0;
+			case Pieces::BISHOP: return (idx == 2 || idx == 5) ? -30 : 0;
+			case Pieces::KING: return (idx == 4) ? -24 : 0;
+			case Pieces::PAWN: return rank * 10 - ((idx == 11 || idx == 12) ? 33 : 0);
+			default: return 0;
+		}
+	}
+
+	/// Bonus of a white piece on a square in the endgame
+	constexpr int _Eg_bonus(int type, int idx) {
+		int rank = idx >> 3;
+		switch (type) {
+			// The king should take part in the endgame
+			case Pieces::KING: return (3 - _Center_distance(idx)) * 10;
+			case Pieces::PAWN: return rank * 15;
+			default: return 0;
+		}
+	}
+
+	constexpr Tables _Generate_tables() {
+		Tables tables{};
+
+		for (int type = Pieces::KING; type <= Pieces::PAWN; type++) {
+			for (int idx = 0; idx < 64; idx++) {
+				int mg = MG_VALUES[type] + _Mg_bonus(type, idx);
+				int eg = EG_VALUES[type] + _Eg_bonus(type, idx);
+
+				// Black uses the same table mirrored vertically
+				tables.mg[6 + type][idx] = (int16_t)mg;
+				tables.eg[6 + type][idx] = (int16_t)eg;
+				tables.mg[6 - type][idx ^ 56] = (int16_t)-mg;
+				tables.eg[6 - type][idx ^ 56] = (int16_t)-eg;
+			}
+		}
+
+		return tables;
+	}
+
+	inline constexpr Tables TABLES = _Generate_tables();
+
+	_ForceInline int mg(int piece, uint32_t idx) {
+		return TABLES.mg[piece + 6][idx];
+	}
+
+	_ForceInline int eg(int piece, uint32_t idx) {
+		return TABLES.eg[piece + 6][idx];
+	}
+
+	_ForceInline int phase(int piece) {
+		return PHASE_WEIGHTS[piece + 6];
+	}
+
+	/// Blend a middlegame and an endgame value by the game phase of the board
+	_ForceInline int taper(Chessboard& board, int mg, int eg) {
+		int phase = board.phase < PHASE_MAX ? board.phase : PHASE_MAX;
+		return (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX;
+	}
+
+	/// Calculate the piece-square sums and game phase of a board from scratch
+	inline void compute(Chessboard& board) {
+		board.psqtMg = 0;
+		board.psqtEg = 0;
+		board.phase = 0;
+		for (uint32_t idx = 0; idx < 64; idx++) {
+			board.psqtMg += mg(board.pieces[idx], idx);
+			board.psqtEg += eg(board.pieces[idx], idx);
+			board.phase += phase(board.pieces[idx]);
+		}
+	}
+}
+
+#endif // PSQT_H
@@ -0,0 +1,489 @@
+// Batch evaluation and Texel tuning of the classical evaluation weights.
+//
+// usage: tuner <positions> [--threads <n>] [--qsearch] [--k <scale>] [--iterations <n>]
+//
+// Every line of the positions file holds a FEN or EPD position and the result of the
+// game from the view of white, either as `[1.0]`, `[0.5]`, `[0.0]` or as `1-0`, `0-1`,
+// `1/2-1/2` anywhere after the position.
+
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../analyser/ab_pruning_v2.h"
+#include "../analyser/evaluator.h"
+#include "../codec/fen_codec.h"
+
+// Memory used by the tables of every worker
+constexpr size_t TUNER_TABLE_MB = 1;
+
+/// Read only view of a whole file
+class MappedFile {
+public:
+	MappedFile(const std::string& path) {
+#ifdef _WIN32
+		m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE) {
+			return;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+			return;
+		}
+
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr) {
+			return;
+		}
+
+		m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+		m_size = m_data == nullptr ? 0 : (size_t)size.QuadPart;
+#else
+		m_file = open(path.c_str(), O_RDONLY);
+		if (m_file < 0) {
+			return;
+		}
+
+		struct stat info;
+		if (fstat(m_file, &info) != 0 || info.st_size == 0) {
+			return;
+		}
+
+		void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+		if (data != MAP_FAILED) {
+			m_data = (const char*)data;
+			m_size = (size_t)info.st_size;
+		}
+#endif
+	}
+
+	~MappedFile() {
+#ifdef _WIN32
+		if (m_data != nullptr) UnmapViewOfFile(m_data);
+		if (m_mapping != nullptr) CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+		if (m_data != nullptr) munmap((void*)m_data, m_size);
+		if (m_file >= 0) close(m_file);
+#endif
+	}
+
+	const char* data() const {
+		return m_data;
+	}
+
+	size_t size() const {
+		return m_size;
+	}
+
+private:
+#ifdef _WIN32
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+};
+
+/// Fixed set of threads that run the same task over their own slice of the work
+class ThreadPool {
+public:
+	ThreadPool(size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			m_threads.emplace_back(&ThreadPool::worker_loop, this, i);
+		}
+	}
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_running = false;
+		}
+
+		m_condition.notify_all();
+		for (std::thread& thread : m_threads) {
+			thread.join();
+		}
+	}
+
+	size_t size() const {
+		return m_threads.size();
+	}
+
+	/// Run the task on every thread and wait until all of them are done
+	void run(const std::function<void(size_t)>& task) {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_task = &task;
+		m_pending = m_threads.size();
+		m_generation++;
+		m_condition.notify_all();
+		m_done.wait(lock, [this] { return m_pending == 0; });
+		m_task = nullptr;
+	}
+
+private:
+	void worker_loop(size_t index) {
+		uint64_t generation = 0;
+
+		for (;;) {
+			const std::function<void(size_t)>* task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this, generation] { return !m_running || m_generation != generation; });
+				if (!m_running) {
+					return;
+				}
+
+				generation = m_generation;
+				task = m_task;
+			}
+
+			(*task)(index);
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_pending == 0) {
+				m_done.notify_one();
+			}
+		}
+	}
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::condition_variable m_done;
+	const std::function<void(size_t)>* m_task = nullptr;
+	uint64_t m_generation = 0;
+	size_t m_pending = 0;
+	bool m_running = true;
+};
+
+struct TunerPosition {
+	Chessboard board;
+	float result;
+};
+
+/// Tables owned by a single worker
+struct TunerWorker {
+	Evaluator evaluator;
+	TranspositionTable table;
+	SearchStats stats;
+};
+
+/// Returns the result of the game from the view of white or a negative value if the line has none
+static float tn_read_result(const std::string& line) {
+	size_t bracket = line.find('[');
+	if (bracket != std::string::npos) {
+		return (float)atof(line.c_str() + bracket + 1);
+	}
+
+	if (line.find("1/2-1/2") != std::string::npos) return 0.5f;
+	if (line.find("1-0") != std::string::npos) return 1.0f;
+	if (line.find("0-1") != std::string::npos) return 0.0f;
+	return -1.0f;
+}
+
+/// Parse a position. EPD lines do not have move counters so they are added
+static bool tn_read_position(const std::string& line, TunerPosition& position) {
+	position.result = tn_read_result(line);
+	if (position.result < 0.0f) {
+		return false;
+	}
+
+	std::string fields[6];
+	size_t count = 0;
+	size_t index = 0;
+	while (count < 6 && index < line.size()) {
+		size_t end = line.find(' ', index);
+		end = end == std::string::npos ? line.size() : end;
+		if (end > index) {
+			fields[count++] = line.substr(index, end - index);
+		}
+
+		index = end + 1;
+	}
+
+	if (count < 4) {
+		return false;
+	}
+
+	bool counters = count == 6 && isdigit((unsigned char)fields[4][0]) && isdigit((unsigned char)fields[5][0]);
+	std::string fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3]
+		+ (counters ? " " + fields[4] + " " + fields[5] : std::string(" 0 1"));
+	return Codec::FEN::import_fen(position.board, fen) == FEN_CODEC_SUCCESSFUL;
+}
+
+/// Split the file into lines and parse every slice of lines on its own thread
+static std::vector<TunerPosition> tn_load(ThreadPool& pool, const MappedFile& file) {
+	const char* data = file.data();
+	size_t size = file.size();
+	size_t threads = pool.size();
+	std::vector<std::vector<TunerPosition>> parts(threads);
+
+	pool.run([&](size_t thread) {
+		// Every slice starts after the first line break inside it
+		size_t begin = (size * thread) / threads;
+		size_t end = (size * (thread + 1)) / threads;
+		if (thread > 0) {
+			while (begin < size && data[begin - 1] != '\n') begin++;
+		}
+
+		while (begin < end) {
+			const char* line_end = (const char*)memchr(data + begin, '\n', size - begin);
+			size_t next = line_end == nullptr ? size : (size_t)(line_end - data) + 1;
+
+			std::string line(data + begin, next - begin);
+			while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+				line.pop_back();
+			}
+
+			TunerPosition position;
+			if (tn_read_position(line, position)) {
+				parts[thread].push_back(position);
+			}
+
+			begin = next;
+		}
+	});
+
+	std::vector<TunerPosition> positions;
+	for (std::vector<TunerPosition>& part : parts) {
+		positions.insert(positions.end(), part.begin(), part.end());
+	}
+
+	return positions;
+}
+
+class Tuner {
+public:
+	Tuner(ThreadPool& pool, std::vector<TunerPosition>& positions, bool qsearch)
+		: m_pool(pool), m_positions(positions), m_qsearch(qsearch), m_workers(pool.size()), m_scores(positions.size()) {
+		for (TunerWorker& worker : m_workers) {
+			worker.evaluator.resize_pawn_table(TUNER_TABLE_MB);
+			worker.table.resize(TUNER_TABLE_MB);
+		}
+	}
+
+	/// Evaluate every position with the weights
+	void evaluate(const EvalWeights& weights) {
+		size_t threads = m_pool.size();
+		size_t count = m_positions.size();
+
+		m_pool.run([&](size_t thread) {
+			TunerWorker& worker = m_workers[thread];
+			worker.evaluator.set_weights(weights);
+
+			// Search results of other weights can not be reused
+			if (m_qsearch) {
+				worker.table.clear();
+			}
+
+			size_t end = (count * (thread + 1)) / threads;
+			for (size_t i = (count * thread) / threads; i < end; i++) {
+				Chessboard& board = m_positions[i].board;
+
+				if (m_qsearch) {
+					m_scores[i] = an_quiesce_position(worker.table, worker.evaluator, worker.stats, board);
+				} else {
+					AttackInfo attacks;
+					m_scores[i] = worker.evaluator.evaluate(board, 0, attacks);
+				}
+			}
+		});
+
+		m_evaluated += count;
+	}
+
+	/// Returns the mean squared error between the results and the expected results of the last evaluation
+	double error(double k) const {
+		double sum = 0.0;
+		for (size_t i = 0; i < m_positions.size(); i++) {
+			double expected = 1.0 / (1.0 + pow(10.0, -k * m_scores[i] / 400.0));
+			double diff = m_positions[i].result - expected;
+			sum += diff * diff;
+		}
+
+		return m_positions.empty() ? 0.0 : sum / m_positions.size();
+	}
+
+	/// Returns the error of the weights
+	double loss(const EvalWeights& weights, double k) {
+		evaluate(weights);
+		return error(k);
+	}
+
+	/// Find the scaling constant that fits the evaluation of the weights best
+	double fit_k(const EvalWeights& weights) {
+		evaluate(weights);
+
+		double low = 0.1;
+		double high = 4.0;
+		for (int i = 0; i < 60; i++) {
+			double a = low + (high - low) / 3.0;
+			double b = high - (high - low) / 3.0;
+			if (error(a) < error(b)) {
+				high = b;
+			} else {
+				low = a;
+			}
+		}
+
+		return (low + high) / 2.0;
+	}
+
+	/// Central difference of the loss for every parameter
+	std::vector<double> gradient(EvalWeights& weights, double k) {
+		std::vector<EvalWeights::Parameter> parameters = weights.parameters();
+		std::vector<double> result(parameters.size());
+
+		for (size_t i = 0; i < parameters.size(); i++) {
+			int* value = parameters[i].value;
+
+			(*value)++;
+			double upper = loss(weights, k);
+			(*value) -= 2;
+			double lower = loss(weights, k);
+			(*value)++;
+
+			result[i] = (upper - lower) / 2.0;
+		}
+
+		return result;
+	}
+
+	uint64_t evaluated() const {
+		return m_evaluated;
+	}
+
+private:
+	ThreadPool& m_pool;
+	std::vector<TunerPosition>& m_positions;
+	bool m_qsearch;
+	std::vector<TunerWorker> m_workers;
+	std::vector<Score> m_scores;
+	uint64_t m_evaluated = 0;
+};
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: tuner <positions> [--threads <n>] [--qsearch] [--k <scale>] [--iterations <n>]\n");
+		return 1;
+	}
+
+	size_t threads = std::thread::hardware_concurrency();
+	bool qsearch = false;
+	double k = 0.0;
+	int iterations = 0;
+
+	for (int i = 2; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) {
+			threads = (size_t)atoi(argv[++i]);
+		} else if (arg == "--qsearch") {
+			qsearch = true;
+		} else if (arg == "--k" && i + 1 < argc) {
+			k = atof(argv[++i]);
+		} else if (arg == "--iterations" && i + 1 < argc) {
+			iterations = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "Unknown argument [%s]\n", arg.c_str());
+			return 1;
+		}
+	}
+
+	threads = threads == 0 ? 1 : threads;
+
+	MappedFile file(argv[1]);
+	if (file.data() == nullptr) {
+		fprintf(stderr, "Could not read the positions [%s]\n", argv[1]);
+		return 1;
+	}
+
+	using namespace std::chrono;
+	ThreadPool pool(threads);
+	auto start_time = steady_clock::now();
+	std::vector<TunerPosition> positions = tn_load(pool, file);
+	printf("loaded %zu positions in %lld ms\n", positions.size(),
+		(long long)duration_cast<milliseconds>(steady_clock::now() - start_time).count());
+
+	if (positions.empty()) {
+		return 1;
+	}
+
+	Tuner tuner(pool, positions, qsearch);
+	EvalWeights weights;
+
+	start_time = steady_clock::now();
+	if (k == 0.0) {
+		k = tuner.fit_k(weights);
+	}
+
+	double best = tuner.loss(weights, k);
+	printf("k %.4f loss %.8f\n", k, best);
+
+	std::vector<EvalWeights::Parameter> parameters = weights.parameters();
+	std::vector<double> gradient = tuner.gradient(weights, k);
+	for (size_t i = 0; i < parameters.size(); i++) {
+		printf("gradient %-24s %6d %+.10f\n", parameters[i].name.c_str(), *parameters[i].value, gradient[i]);
+	}
+
+	// Local search that moves every parameter one step against its gradient
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		bool improved = false;
+
+		for (size_t i = 0; i < parameters.size(); i++) {
+			if (gradient[i] == 0.0) {
+				continue;
+			}
+
+			int step = gradient[i] > 0.0 ? -1 : 1;
+			*parameters[i].value += step;
+
+			double value = tuner.loss(weights, k);
+			if (value < best) {
+				best = value;
+				improved = true;
+			} else {
+				*parameters[i].value -= step;
+			}
+		}
+
+		printf("iteration %d loss %.8f\n", iteration + 1, best);
+		if (!improved) {
+			break;
+		}
+
+		gradient = tuner.gradient(weights, k);
+	}
+
+	int64_t millis = duration_cast<milliseconds>(steady_clock::now() - start_time).count();
+	printf("evaluated %llu positions in %lld ms (%llu per second)\n",
+		(unsigned long long)tuner.evaluated(), (long long)millis,
+		(unsigned long long)((tuner.evaluated() * 1000ull) / (millis + 1)));
+
+	for (EvalWeights::Parameter& parameter : parameters) {
+		printf("%s %d\n", parameter.name.c_str(), *parameter.value);
+	}
+
+	return 0;
+}
@@ -5,6 +5,7 @@
 #include "../codec/str_codec.h"
 #include "../generator.h"
 #include "../serial.h"
+#include "../logger.h"
 
 void _Debug_options(ChessAnalyser* analyser) {
 	for (UciOption* option : analyser->get_options()) {
@@ -52,11 +53,10 @@ UciManager::UciManager(const std::string author, const std::string name, ChessAn
 	Codec::FEN::import_fen(m_analysis.board, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 0");
 }
 
-/*
-bool UciManager::process_ponderhit(std::string command) {
-	return false;
+bool UciManager::process_ponderhit() {
+	m_analyser->ponderhit();
+	return true;
 }
-*/
 
 template <bool White>
 static long goDepth(Chessboard& parent, int depth) {
@@ -129,98 +129,110 @@ void UciManager::print_perft(int depth) {
 	computePerft(m_analysis.board, depth);
 }
 
-bool UciManager::process_go(std::string command) {
+bool UciManager::process_go(Codec::STR::Tokenizer& tokens) {
 	// http://wbec-ridderkerk.nl/html/UCIProtocol.html
-	// TODO: Implement this method
-	// TODO: Implement 'searchmoves'
-	// TODO: Implement 'ponder'
-	// TODO: Implement 'movestogo'
-
-	// Remove 'go'
-	command = command.substr(2);
-
-	uint64_t wtime{0xffffffffffffffffull};
-	uint64_t btime{0xffffffffffffffffull};
-	uint64_t winc{};
-	uint64_t binc{};
-	bool infinite{};
-
-	if (command._Starts_with(" perft ")) {
-		command = command.substr(7);
+	SearchLimits limits{};
+
+	if (tokens.peek() == "perft") {
+		tokens.next();
 		uint64_t depth = 1;
-		command = Codec::STR::read_integer<uint64_t>(command, depth);
+		tokens.next_integer(depth);
 		print_perft((int)depth);
 		return true;
 	}
 
-	if (command._Starts_with(" infinite")) {
-		infinite = true;
-		command = command.substr(9);
-	}
-
-	if (command._Starts_with(" movetime ")) {
-		command = command.substr(10);
-		command = Codec::STR::read_integer<uint64_t>(command, wtime);
-		btime = wtime;
-	}
-
-	if (command._Starts_with(" wtime ")) {
-		command = command.substr(7);
-		command = Codec::STR::read_integer<uint64_t>(command, wtime);
-	}
-
-	if (command._Starts_with(" btime ")) {
-		command = command.substr(7);
-		command = Codec::STR::read_integer<uint64_t>(command, btime);
-	}
+	for (std::string_view token = tokens.next(); !token.empty(); token = tokens.next()) {
+		uint64_t* value = nullptr;
+
+		// Times can be negative when the clock already ran out and are clamped instead of rejected
+		bool is_time = false;
+		int64_t minimum = 0;
+
+		if (token == "ponder") {
+			limits.m_ponder = true;
+		} else if (token == "infinite") {
+			limits.m_infinite = true;
+		} else if (token == "searchmoves") {
+			read_search_moves(tokens, limits.m_searchmoves);
+		} else if (token == "movetime") {
+			value = &limits.m_movetime;
+			is_time = true;
+			minimum = 1;
+		} else if (token == "wtime") {
+			value = &limits.m_time[0];
+			is_time = true;
+			minimum = 1;
+		} else if (token == "btime") {
+			value = &limits.m_time[1];
+			is_time = true;
+			minimum = 1;
+		} else if (token == "winc") {
+			value = &limits.m_inc[0];
+			is_time = true;
+		} else if (token == "binc") {
+			value = &limits.m_inc[1];
+			is_time = true;
+		} else if (token == "movestogo") {
+			value = &limits.m_movestogo;
+		} else if (token == "depth") {
+			value = &limits.m_depth;
+		} else if (token == "nodes") {
+			value = &limits.m_nodes;
+		} else if (token == "mate") {
+			value = &limits.m_mate;
+		} else {
+			LOG(LOG_WARNING, "Failed to fully parse the go command at [%.*s]", (int)token.size(), token.data());
+			break;
+		}
 
-	if (command._Starts_with(" winc ")) {
-		command = command.substr(6);
-		command = Codec::STR::read_integer<uint64_t>(command, winc);
-	}
+		if (value == nullptr) {
+			continue;
+		}
 
-	if (command._Starts_with(" binc ")) {
-		command = command.substr(6);
-		command = Codec::STR::read_integer<uint64_t>(command, binc);
-	}
+		// An invalid value only drops that limit, the rest of the command is still used
+		std::string_view number = tokens.next();
+		int64_t parsed = 0;
+		if (!Codec::STR::read_integer(number, parsed) || (!is_time && parsed < 0)) {
+			LOG(LOG_WARNING, "Expected a number after [%.*s] but got [%.*s]", (int)token.size(), token.data(), (int)number.size(), number.data());
+			continue;
+		}
 
-	if (!command.empty()) {
-		fprintf(stderr, "Failed to fully parse the go command\n");
+		*value = (uint64_t)(parsed < minimum ? minimum : parsed);
 	}
 
-	bool is_white = Board::isWhite(m_analysis.board);
-	uint64_t turn_inc = is_white ? winc : binc;
-	uint64_t turn_time = is_white ? wtime : btime;
-
-	if (infinite) {
-		m_analysis.m_max_time = (uint32_t)(100000000);
-	} else {
-		m_analysis.m_max_time = (uint32_t)(turn_time > 100000 ? 10000 : ((turn_time / 10) + 1));
-	}
+	m_analysis.m_limits = limits;
 	m_analyser->start_analysis(m_analysis);
 
 	return true;
 }
 
-bool UciManager::process_position_moves(std::string command) {
-	// fprintf(stderr, "Remaining: [%s]\n", command.c_str());
+void UciManager::read_search_moves(Codec::STR::Tokenizer& tokens, std::vector<Move>& searchmoves) {
+	std::vector<Move> moves = Generator::generate_valid_moves(m_analysis.board);
 
-	while (!command.empty()) {
-		size_t first_space = command.find_first_of(' ');
+	// Read moves until the next token is not a valid move
+	for (std::string_view move_str = tokens.peek(); !move_str.empty(); move_str = tokens.peek()) {
+		bool found = false;
+		for (Move move : moves) {
+			if (move_str == Serial::get_move_string(move)) {
+				searchmoves.push_back(move);
+				found = true;
+				break;
+			}
+		}
 
-		std::string move_str = (first_space == -1) ? command : command.substr(0, first_space);
-		if (first_space != -1) {
-			command = command.substr((size_t)first_space + 1ull);
-		} else {
-			command = "";
+		if (!found) {
+			break;
 		}
 
-		// fprintf(stderr, "info string [%s]\n", move_str.c_str());
+		tokens.next();
+	}
+}
+
+bool UciManager::process_position_moves(Codec::STR::Tokenizer& tokens) {
+	for (std::string_view move_str = tokens.next(); !move_str.empty(); move_str = tokens.next()) {
 		bool found = false;
 		std::vector<Move> moves = Generator::generate_valid_moves(m_analysis.board);
 		for (Move move : moves) {
-			// fprintf(stderr, "info string [%s] <=> [%s]\n", move_str.c_str(), Serial::get_move_string(move).c_str());
-
 			if (move_str == Serial::get_move_string(move)) {
 				found = Generator::playMove(m_analysis.board, move);
 				break;
@@ -228,7 +240,7 @@ bool UciManager::process_position_moves(std::string command) {
 		}
 
 		if (!found) {
-			fprintf(stderr, "into string Could not play the move [%s]\n", move_str.c_str());
+			LOG(LOG_ERROR, "Could not play the move [%.*s]", (int)move_str.size(), move_str.data());
 			return false;
 		}
 	}
@@ -236,97 +248,101 @@ bool UciManager::process_position_moves(std::string command) {
 	return true;
 }
 
-bool UciManager::process_position(std::string command) {
-	if (command._Starts_with("position fen ")) {
-		command = command.substr(13);
+bool UciManager::process_position(Codec::STR::Tokenizer& tokens) {
+	std::string_view type = tokens.next();
+
+	if (type == "fen") {
+		// Only the fen itself is copied, the moves are read from the command
+		std::string_view rest = tokens.rest();
+		std::string fen(rest.substr(0, rest.find(" moves")));
+
 		int matched;
-		if (Codec::FEN::import_fen(m_analysis.board, command, matched) != FEN_CODEC_SUCCESSFUL) {
-			fprintf(stderr, "Invalid usage of 'position fen'. Invalid fen [%s]\n", command.c_str());
+		if (Codec::FEN::import_fen(m_analysis.board, fen, matched) != FEN_CODEC_SUCCESSFUL) {
+			LOG(LOG_ERROR, "Invalid usage of 'position fen'. Invalid fen [%s]", fen.c_str());
 			return false;
 		}
 
-		command = command.substr(matched);
-	} else if (command._Starts_with("position startpos")) {
-		command = command.substr(17);
-		int matched;
-		if (Codec::FEN::import_fen(m_analysis.board, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 0", matched) != FEN_CODEC_SUCCESSFUL) {
-			fprintf(stderr, "Invalid usage of 'position fen'. Invalid fen [%s]\n", command.c_str());
+		tokens.skip((size_t)matched);
+	} else if (type == "startpos") {
+		if (Codec::FEN::import_fen(m_analysis.board, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 0") != FEN_CODEC_SUCCESSFUL) {
+			LOG(LOG_ERROR, "Invalid usage of 'position startpos'");
 			return false;
 		}
-
 	} else {
-		fprintf(stderr, "Invalid usage of 'position'. Expected 'fen' or 'startpos' but got [%s]\n", command.c_str());
+		LOG(LOG_ERROR, "Invalid usage of 'position'. Expected 'fen' or 'startpos' but got [%.*s]", (int)type.size(), type.data());
 		return false;
 	}
 
 	// Check if there is more data to parse
-	if (command.empty()) {
+	std::string_view next = tokens.next();
+	if (next.empty()) {
 		return true;
-	} else if (command[0] != ' ') {
-		fprintf(stderr, "Invalid usage of 'position'. Expected space after fen [%s]\n", command.c_str());
-		return false;
 	}
 
-	if (command._Starts_with(" moves ")) {
-		command = command.substr(7);
-		return process_position_moves(command);
+	if (next == "moves") {
+		return process_position_moves(tokens);
 	}
 
+	LOG(LOG_ERROR, "Invalid usage of 'position'. Expected 'moves' but got [%.*s]", (int)next.size(), next.data());
 	return false;
 }
 
-bool UciManager::process_setoption(std::string command) {
-	if (!command._Starts_with("setoption name ")) {
-		fprintf(stderr, "Invalid usage of 'setoption' [%s]\n", command.c_str());
+bool UciManager::process_setoption(Codec::STR::Tokenizer& tokens) {
+	if (tokens.next() != "name") {
+		LOG(LOG_ERROR, "Invalid usage of 'setoption'. Expected 'name'");
 		return false;
 	}
 
-	// Remove the alias from the command
-	command = command.substr(15);
-
-	// Match the longest command
+	// Option names may contain spaces so match the longest name
+	std::string_view command = tokens.rest();
 	UciOption* option = nullptr;
 	for (UciOption* item : m_analyser->get_options()) {
-		if (command._Starts_with(item->get_key()) && (option == nullptr || (item->get_key().length() > option->get_key().length()))) {
+		if (Codec::STR::starts_with(command, item->get_key()) && (option == nullptr || (item->get_key().length() > option->get_key().length()))) {
 			option = item;
 		}
 	}
 
 	if (option == nullptr) {
-		fprintf(stderr, "Invalid usage of 'setoption'. The option [%s] does not exist\n", command.c_str());
+		LOG(LOG_ERROR, "Invalid usage of 'setoption'. The option [%.*s] does not exist", (int)command.size(), command.data());
 		return false;
 	}
 
 	// Removed the matched name from the command
-	command = command.substr(option->get_key().length());
+	command.remove_prefix(option->get_key().length());
 
 	if (option->get_type() != UciOptionType::BUTTON) {
-		if (!command._Starts_with(" value ")) {
-			fprintf(stderr, "Invalid usage of 'setoption'. Value tag was missing\n");
+		if (!Codec::STR::starts_with(command, " value ")) {
+			LOG(LOG_ERROR, "Invalid usage of 'setoption'. Value tag was missing");
 			return false;
 		}
 
 		// Remove ' value ' text
-		command = command.substr(7);
+		command.remove_prefix(7);
 	}
 
-	return m_analyser->set_option(option->get_key(), command);
+	std::string value(command);
+	return m_analyser->set_option(option->get_key(), value);
 }
 
-bool UciManager::process_debug_command(std::string command) {
+bool UciManager::process_debug_command(std::string_view command) {
 	if (command == "@debugoptions") {
 		_Debug_options(m_analyser);
 	} else if (command == "@debugboard") {
 		fprintf(stderr, "%s\n", Serial::get_board_string(m_analysis.board).c_str());
 	} else if (command == "@debugfen") {
 		fprintf(stderr, "%s\n", Codec::FEN::export_fen(m_analysis.board).c_str());
+	} else if (command == "@stats") {
+		fprintf(stderr, "info string stats %s\n", m_analyser->get_statistics().c_str());
 	}
 
 	return true;
 }
 
-bool UciManager::process_command(std::string command) {
-	if (command == "uci") {
+bool UciManager::process_command(std::string_view command) {
+	Codec::STR::Tokenizer tokens(command);
+	std::string_view name = tokens.next();
+
+	if (name == "uci") {
 		printf("id name %s\n", m_name.c_str());
 		printf("id author %s\n", m_author.c_str());
 
@@ -336,37 +352,34 @@ bool UciManager::process_command(std::string command) {
 
 		printf("uciok\n");
 		return true;
-	} else if (command == "ucinewgame") {
+	} else if (name == "ucinewgame") {
+		m_analyser->new_game();
 		return true;
-	} else if (command == "stop") {
+	} else if (name == "stop") {
 		m_analyser->stop_analysis();
 		return true;
-	} else if (command == "quit") {
+	} else if (name == "ponderhit") {
+		return process_ponderhit();
+	} else if (name == "quit") {
 		m_running = false;
 		return true;
-	} else if (command == "isready") {
+	} else if (name == "isready") {
 		printf("readyok\n");
 		return true;
 	}
 
-	if (command._Starts_with("go")) { 
-		return process_go(command);
+	if (name == "go") {
+		return process_go(tokens);
 	}
 
-	if (command._Starts_with("setoption")) {
-		return process_setoption(command);
-	} else if (command._Starts_with("position")) {
+	if (name == "setoption") {
+		return process_setoption(tokens);
+	} else if (name == "position") {
 		// TODO: calulate the hash of each board and store them to check for threefold repetition
-		return process_position(command);
-	} else if (command._Starts_with("@")) {
-		return process_debug_command(command);
-	}
-	
-	/*
-	if (alias == "ponderhit") {
-		return process_ponderhit(command);
+		return process_position(tokens);
+	} else if (Codec::STR::starts_with(name, "@")) {
+		return process_debug_command(name);
 	}
-	*/
 
 	return false;
 }
@@ -377,7 +390,7 @@ void UciManager::run() {
 		std::getline(std::cin, command);
 		if (!process_command(command)) {
 			// Invalid command
-			fprintf(stderr, "Unknown uci command [%s]\n", command.c_str());
+			LOG(LOG_WARNING, "Unknown uci command [%s]", command.c_str());
 		}
 	}
 }
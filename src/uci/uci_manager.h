@@ -2,7 +2,9 @@
 #define UCI_MANAGER_H
 
 #include <string>
+#include <string_view>
 #include "../analyser/chess_analyser.h"
+#include "../codec/str_codec.h"
 
 // TODO: Potential name 'CLIManager'
 class UciManager {
@@ -11,7 +13,7 @@ public:
 
 	/// Process a uci command
 	/// @return `false` if the command was not processed
-	bool process_command(std::string command);
+	bool process_command(std::string_view command);
 
 	/// Process std::cin until the process is closed
 	void run();
@@ -20,11 +22,13 @@ public:
 	bool running();
 private:
 	void print_perft(int depth);
-	bool process_go(std::string command);
-	bool process_position_moves(std::string command);
-	bool process_position(std::string command);
-	bool process_setoption(std::string command);
-	bool process_debug_command(std::string command);
+	bool process_go(Codec::STR::Tokenizer& tokens);
+	bool process_ponderhit();
+	void read_search_moves(Codec::STR::Tokenizer& tokens, std::vector<Move>& searchmoves);
+	bool process_position_moves(Codec::STR::Tokenizer& tokens);
+	bool process_position(Codec::STR::Tokenizer& tokens);
+	bool process_setoption(Codec::STR::Tokenizer& tokens);
+	bool process_debug_command(std::string_view command);
 	
 	const std::string m_author;
 	const std::string m_name;
@@ -14,6 +14,10 @@ namespace Utils {
         _BitScanForward64(&r, i);
         return (uint8_t)r;
     }
+
+    inline int bitCount(uint64_t i) {
+        return (int)__popcnt64(i);
+    }
 }
 
 #endif // UTILS_H
@@ -12,6 +12,13 @@ struct Chessboard {
 	int lastPawn;
 	int halfMove;
 	int flags;
+	uint64_t hash;
+	uint64_t pawnHash;
+
+	// Incremental material, piece-square sums and game phase
+	int psqtMg;
+	int psqtEg;
+	int phase;
 };
 
 // Chess move hash table
@@ -0,0 +1,98 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "utils_type.h"
+#include "pieces.h"
+
+namespace Zobrist {
+	struct Keys {
+		uint64_t pieces[13][64];
+		uint64_t castling[16];
+		uint64_t en_passant[64];
+		uint64_t side;
+	};
+
+	constexpr uint64_t _Next_random(uint64_t& state) {
+		// xorshift64*
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545f4914f6cdd1dull;
+	}
+
+	constexpr Keys _Generate_keys() {
+		Keys keys{};
+		uint64_t state = 0x9e3779b97f4a7c15ull;
+
+		for (int piece = 0; piece < 13; piece++) {
+			for (int idx = 0; idx < 64; idx++) {
+				// Empty squares never change the hash
+				keys.pieces[piece][idx] = (piece == 6) ? 0 : _Next_random(state);
+			}
+		}
+
+		for (int flags = 0; flags < 16; flags++) {
+			keys.castling[flags] = (flags == 0) ? 0 : _Next_random(state);
+		}
+
+		// The square zero is used when there is no en passant square
+		for (int idx = 0; idx < 64; idx++) {
+			keys.en_passant[idx] = (idx == 0) ? 0 : _Next_random(state);
+		}
+
+		keys.side = _Next_random(state);
+		return keys;
+	}
+
+	inline constexpr Keys KEYS = _Generate_keys();
+
+	_ForceInline uint64_t piece(int piece, uint32_t idx) {
+		return KEYS.pieces[piece + 6][idx];
+	}
+
+	/// Returns the key of a piece if it is a pawn and zero otherwise
+	_ForceInline uint64_t pawn(int piece, uint32_t idx) {
+		return (piece == Pieces::W_PAWN || piece == Pieces::B_PAWN) ? KEYS.pieces[piece + 6][idx] : 0;
+	}
+
+	_ForceInline uint64_t castling(int flags) {
+		return KEYS.castling[flags & 15];
+	}
+
+	_ForceInline uint64_t en_passant(int idx) {
+		return KEYS.en_passant[idx];
+	}
+
+	_ForceInline uint64_t side() {
+		return KEYS.side;
+	}
+
+	/// Calculate the hash of a board from scratch
+	inline uint64_t compute_hash(Chessboard& board) {
+		uint64_t hash = 0;
+		for (uint32_t idx = 0; idx < 64; idx++) {
+			hash ^= piece(board.pieces[idx], idx);
+		}
+
+		hash ^= castling(board.flags);
+		hash ^= en_passant(board.lastPawn);
+
+		if ((board.halfMove & 1) != 0) {
+			hash ^= side();
+		}
+
+		return hash;
+	}
+
+	/// Calculate the hash of the pawns of a board from scratch
+	inline uint64_t compute_pawn_hash(Chessboard& board) {
+		uint64_t hash = 0;
+		for (uint32_t idx = 0; idx < 64; idx++) {
+			hash ^= pawn(board.pieces[idx], idx);
+		}
+
+		return hash;
+	}
+}
+
+#endif // ZOBRIST_H